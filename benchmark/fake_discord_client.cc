@@ -0,0 +1,279 @@
+#include "fake_discord_client.h"
+
+#include <utility>
+
+namespace {
+  auto constexpr kDiscordEpoch = std::chrono::milliseconds(1420070400000);
+  auto constexpr kSnowflakeTimestampShift = 22;
+  auto constexpr kSnowflakeSequenceMask = (1ULL << kSnowflakeTimestampShift) - 1;
+  auto constexpr kNotFoundStatus = 404;
+  auto constexpr kNotFoundBody = R"({"code": 10008, "message": "Unknown Message"})";
+
+  std::string GetRoute(std::string const& endpoint, dpp::snowflake const resource_id) noexcept {
+    return endpoint + ":" + std::to_string(resource_id);
+  }
+}
+
+FakeDiscordClient::FakeDiscordClient(dpp::snowflake const bot_user_id, uint64_t const route_limit, uint64_t const global_limit,
+                                     std::chrono::milliseconds const latency) :
+  bot_user_id_(bot_user_id),
+  rest_backend_(route_limit, global_limit, latency) {
+}
+
+dpp::snowflake FakeDiscordClient::GetSnowflake(std::chrono::system_clock::time_point const time, uint64_t const sequence) noexcept {
+  auto const milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()) - kDiscordEpoch;
+  return (static_cast<uint64_t>(milliseconds.count()) << kSnowflakeTimestampShift) | (sequence & kSnowflakeSequenceMask);
+}
+
+void FakeDiscordClient::AddUser(dpp::snowflake const user_id, std::string const& username) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+  users_usernames_[user_id] = username;
+}
+
+void FakeDiscordClient::AddMessage(dpp::snowflake const message_id, dpp::snowflake const channel_id, dpp::snowflake const author_id) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+  auto& stored_message = channels_messages_[channel_id][message_id];
+  stored_message.message.id = message_id;
+  stored_message.message.channel_id = channel_id;
+  stored_message.message.author = GetUser(author_id);
+}
+
+bool FakeDiscordClient::AddReaction(dpp::snowflake const message_id, dpp::snowflake const user_id, std::string const& reaction) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+  for (auto& [channel_id, messages] : channels_messages_) {
+    auto const it_message = messages.find(message_id);
+    if (messages.end() != it_message) {
+      it_message->second.reactions_users[reaction].insert(user_id);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool FakeDiscordClient::RemoveReaction(dpp::snowflake const message_id, dpp::snowflake const user_id, std::string const& reaction) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+  for (auto& [channel_id, messages] : channels_messages_) {
+    auto const it_message = messages.find(message_id);
+    if (messages.end() == it_message) {
+      continue;
+    }
+
+    auto& reactions_users = it_message->second.reactions_users;
+    auto const it_reaction_users = reactions_users.find(reaction);
+    if ((reactions_users.end() == it_reaction_users) || (0 == it_reaction_users->second.erase(user_id))) {
+      return false;
+    }
+
+    if (it_reaction_users->second.empty()) {
+      reactions_users.erase(it_reaction_users);
+    }
+    return true;
+  }
+
+  return false;
+}
+
+void FakeDiscordClient::SetBotReactionCallback(std::function<void(dpp::snowflake, std::string const&)> bot_reaction_callback) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+  bot_reaction_callback_ = std::move(bot_reaction_callback);
+}
+
+size_t FakeDiscordClient::GetRequests() const noexcept {
+  return rest_backend_.GetRequests();
+}
+
+size_t FakeDiscordClient::GetTooManyRequests() const noexcept {
+  return rest_backend_.GetTooManyRequests();
+}
+
+size_t FakeDiscordClient::GetDirectMessages() const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+  return direct_messages_;
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::DirectMessageCreate(dpp::snowflake const user_id, dpp::message const& message) {
+  return rest_backend_.Request(::GetRoute("direct_message_create", user_id), [this, message](dpp::confirmation_callback_t& result){
+    std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+    ++direct_messages_;
+    result.value = message;
+  });
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::MessageCreate(dpp::message const& message) {
+  return rest_backend_.Request(::GetRoute("message_create", message.channel_id), [this, message](dpp::confirmation_callback_t& result){
+    std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+    auto created_message = message;
+    created_message.id = GetSnowflake(std::chrono::system_clock::now(), next_sequence_++);
+    created_message.author = GetUser(bot_user_id_);
+    channels_messages_[message.channel_id][created_message.id].message = created_message;
+    result.value = created_message;
+  });
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::MessageEdit(dpp::message const& message) {
+  return rest_backend_.Request(::GetRoute("message_edit", message.channel_id), [this, message](dpp::confirmation_callback_t& result){
+    std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+    auto* const stored_message = FindMessage(message.id, message.channel_id);
+    if (nullptr == stored_message) {
+      SetNotFound(result);
+      return;
+    }
+
+    stored_message->message.content = message.content;
+    result.value = GetMessage(*stored_message);
+  });
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::MessageDelete(dpp::snowflake const message_id, dpp::snowflake const channel_id) {
+  return rest_backend_.Request(::GetRoute("message_delete", channel_id), [this, message_id, channel_id](dpp::confirmation_callback_t& result){
+    std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+    if (0 == channels_messages_[channel_id].erase(message_id)) {
+      SetNotFound(result);
+      return;
+    }
+
+    result.value = dpp::confirmation{true};
+  });
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::MessageGet(dpp::snowflake const message_id, dpp::snowflake const channel_id) {
+  return rest_backend_.Request(::GetRoute("message_get", channel_id), [this, message_id, channel_id](dpp::confirmation_callback_t& result){
+    std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+    auto const* const stored_message = FindMessage(message_id, channel_id);
+    if (nullptr == stored_message) {
+      SetNotFound(result);
+      return;
+    }
+
+    result.value = GetMessage(*stored_message);
+  });
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::MessagesGet(dpp::snowflake const channel_id, dpp::snowflake const around,
+                                                                        dpp::snowflake const before, dpp::snowflake const after,
+                                                                        uint64_t const limit) {
+  return rest_backend_.Request(::GetRoute("messages_get", channel_id), [this, channel_id, before, after, limit](dpp::confirmation_callback_t& result){
+    std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+    auto const& messages = channels_messages_[channel_id];
+
+    // Pages after a message go forward from it, every other page goes back from before or from the latest message
+    dpp::message_map page;
+    if (0 < after) {
+      for (auto it_message = messages.upper_bound(after); (messages.cend() != it_message) && (page.size() < limit); ++it_message) {
+        page.emplace(it_message->first, GetMessage(it_message->second));
+      }
+    } else {
+      auto it_message = (0 < before) ? messages.lower_bound(before) : messages.cend();
+      while ((messages.cbegin() != it_message) && (page.size() < limit)) {
+        --it_message;
+        page.emplace(it_message->first, GetMessage(it_message->second));
+      }
+    }
+
+    result.value = std::move(page);
+  });
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::MessageGetReactions(dpp::message const& message, std::string const& reaction,
+                                                                                dpp::snowflake const before, dpp::snowflake const after,
+                                                                                dpp::snowflake const limit) {
+  return rest_backend_.Request(::GetRoute("reactions_get", message.channel_id), [this, message_id = message.id, channel_id = message.channel_id, reaction]
+                                                                                (dpp::confirmation_callback_t& result){
+    std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+    auto const* const stored_message = FindMessage(message_id, channel_id);
+    if (nullptr == stored_message) {
+      SetNotFound(result);
+      return;
+    }
+
+    dpp::user_map reaction_users;
+    auto const it_reaction_users = stored_message->reactions_users.find(reaction);
+    if (stored_message->reactions_users.cend() != it_reaction_users) {
+      for (auto const user_id : it_reaction_users->second) {
+        reaction_users.emplace(user_id, GetUser(user_id));
+      }
+    }
+
+    result.value = std::move(reaction_users);
+  });
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::MessageAddReaction(dpp::message const& message, std::string const& reaction) {
+  return rest_backend_.Request(::GetRoute("reaction_add", message.channel_id), [this, message_id = message.id, channel_id = message.channel_id, reaction]
+                                                                               (dpp::confirmation_callback_t& result){
+    std::function<void(dpp::snowflake, std::string const&)> bot_reaction_callback;
+    {
+      std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+      auto* const stored_message = FindMessage(message_id, channel_id);
+      if (nullptr == stored_message) {
+        SetNotFound(result);
+        return;
+      }
+
+      stored_message->reactions_users[reaction].insert(bot_user_id_);
+      bot_reaction_callback = bot_reaction_callback_;
+    }
+
+    result.value = dpp::confirmation{true};
+    if (bot_reaction_callback) {
+      bot_reaction_callback(message_id, reaction);
+    }
+  });
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeDiscordClient::UserGetCached(dpp::snowflake const user_id) {
+  return rest_backend_.Request(::GetRoute("user_get", user_id), [this, user_id](dpp::confirmation_callback_t& result){
+    std::lock_guard<std::mutex> const mutex_lock_guard(discord_mutex_);
+    if (!users_usernames_.contains(user_id)) {
+      SetNotFound(result);
+      return;
+    }
+
+    dpp::user_identified user;
+    static_cast<dpp::user&>(user) = GetUser(user_id);
+    result.value = user;
+  });
+}
+
+FakeDiscordClient::StoredMessage* FakeDiscordClient::FindMessage(dpp::snowflake const message_id, dpp::snowflake const channel_id) noexcept {
+  auto const it_channel_messages = channels_messages_.find(channel_id);
+  if (channels_messages_.end() == it_channel_messages) {
+    return nullptr;
+  }
+
+  auto const it_message = it_channel_messages->second.find(message_id);
+  return (it_channel_messages->second.end() != it_message) ? &it_message->second : nullptr;
+}
+
+dpp::message FakeDiscordClient::GetMessage(StoredMessage const& stored_message) const noexcept {
+  // Reactions are seen from the bot's side, the same as D++ reports them
+  auto message = stored_message.message;
+  for (auto const& [reaction, users_ids] : stored_message.reactions_users) {
+    dpp::reaction message_reaction;
+    message_reaction.count = users_ids.size();
+    message_reaction.count_normal = users_ids.size();
+    message_reaction.emoji_name = reaction.substr(0, reaction.find(':'));
+    message_reaction.me = users_ids.contains(bot_user_id_);
+    message.reactions.push_back(message_reaction);
+  }
+
+  return message;
+}
+
+dpp::user FakeDiscordClient::GetUser(dpp::snowflake const user_id) const noexcept {
+  dpp::user user;
+  user.id = user_id;
+
+  auto const it_user_username = users_usernames_.find(user_id);
+  if (users_usernames_.cend() != it_user_username) {
+    user.username = it_user_username->second;
+  }
+
+  return user;
+}
+
+void FakeDiscordClient::SetNotFound(dpp::confirmation_callback_t& result) noexcept {
+  result.http_info.status = kNotFoundStatus;
+  result.http_info.body = kNotFoundBody;
+}
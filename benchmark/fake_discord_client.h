@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include <dpp/dpp.h>
+
+#include "discord/discord_client.h"
+#include "fake_rest_backend.h"
+
+// An in-memory Discord for replaying events offline. Holds the messages of every channel with their reactions and
+// answers the REST calls the bot makes from them, after the latency and within the rate limits of a FakeRestBackend.
+// Messages, users and other people's reactions are added directly, the way gateway events would bring them in.
+class FakeDiscordClient final : public DiscordClient {
+public:
+  FakeDiscordClient() = delete;
+  ~FakeDiscordClient() override = default;
+
+  FakeDiscordClient(dpp::snowflake bot_user_id, uint64_t route_limit, uint64_t global_limit, std::chrono::milliseconds latency);
+
+  static dpp::snowflake GetSnowflake(std::chrono::system_clock::time_point time, uint64_t sequence) noexcept;
+
+  void AddUser(dpp::snowflake user_id, std::string const& username) noexcept;
+  void AddMessage(dpp::snowflake message_id, dpp::snowflake channel_id, dpp::snowflake author_id) noexcept;
+  bool AddReaction(dpp::snowflake message_id, dpp::snowflake user_id, std::string const& reaction) noexcept;
+  bool RemoveReaction(dpp::snowflake message_id, dpp::snowflake user_id, std::string const& reaction) noexcept;
+
+  // Called with the message id and reaction every time the bot reacts to a message
+  void SetBotReactionCallback(std::function<void(dpp::snowflake, std::string const&)> bot_reaction_callback) noexcept;
+
+  size_t GetRequests() const noexcept;
+  size_t GetTooManyRequests() const noexcept;
+  size_t GetDirectMessages() const noexcept;
+
+  dpp::async<dpp::confirmation_callback_t> DirectMessageCreate(dpp::snowflake user_id, dpp::message const& message) override;
+  dpp::async<dpp::confirmation_callback_t> MessageCreate(dpp::message const& message) override;
+  dpp::async<dpp::confirmation_callback_t> MessageEdit(dpp::message const& message) override;
+  dpp::async<dpp::confirmation_callback_t> MessageDelete(dpp::snowflake message_id, dpp::snowflake channel_id) override;
+  dpp::async<dpp::confirmation_callback_t> MessageGet(dpp::snowflake message_id, dpp::snowflake channel_id) override;
+  dpp::async<dpp::confirmation_callback_t> MessagesGet(dpp::snowflake channel_id, dpp::snowflake around, dpp::snowflake before,
+                                                       dpp::snowflake after, uint64_t limit) override;
+  dpp::async<dpp::confirmation_callback_t> MessageGetReactions(dpp::message const& message, std::string const& reaction,
+                                                               dpp::snowflake before, dpp::snowflake after, dpp::snowflake limit) override;
+  dpp::async<dpp::confirmation_callback_t> MessageAddReaction(dpp::message const& message, std::string const& reaction) override;
+  dpp::async<dpp::confirmation_callback_t> UserGetCached(dpp::snowflake user_id) override;
+
+private:
+  struct StoredMessage final {
+    dpp::message message;
+    // Keyed by reaction as the REST calls name it, an emoji or name:id for custom ones
+    std::map<std::string, std::set<dpp::snowflake>> reactions_users;
+  };
+
+  StoredMessage* FindMessage(dpp::snowflake message_id, dpp::snowflake channel_id) noexcept;
+  dpp::message GetMessage(StoredMessage const& stored_message) const noexcept;
+  dpp::user GetUser(dpp::snowflake user_id) const noexcept;
+
+  static void SetNotFound(dpp::confirmation_callback_t& result) noexcept;
+
+private:
+  dpp::snowflake const bot_user_id_ = {};
+
+  FakeRestBackend rest_backend_;
+
+  mutable std::mutex discord_mutex_;
+  std::unordered_map<dpp::snowflake, std::string> users_usernames_;
+  std::unordered_map<dpp::snowflake, std::map<dpp::snowflake, StoredMessage>> channels_messages_;
+  uint64_t next_sequence_ = {};
+  size_t direct_messages_ = {};
+  std::function<void(dpp::snowflake, std::string const&)> bot_reaction_callback_;
+};
@@ -0,0 +1,115 @@
+#include "fake_rest_backend.h"
+
+#include <utility>
+
+namespace {
+  auto constexpr kOkStatus = 200;
+  auto constexpr kTooManyRequestsStatus = 429;
+  auto constexpr kWindow = std::chrono::seconds(1);
+
+  uint64_t GetSecondsUntil(std::chrono::steady_clock::time_point const now, std::chrono::steady_clock::time_point const time) noexcept {
+    return static_cast<uint64_t>(std::chrono::ceil<std::chrono::seconds>(time - now).count());
+  }
+}
+
+FakeRestBackend::FakeRestBackend(uint64_t const route_limit, uint64_t const global_limit, std::chrono::milliseconds const latency) :
+  route_limit_(route_limit),
+  global_limit_(global_limit),
+  latency_(latency) {
+  server_thread_ = std::thread([this](){ Serve(); });
+}
+
+FakeRestBackend::~FakeRestBackend() {
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(backend_mutex_);
+    running_ = false;
+  }
+  backend_condition_variable_.notify_one();
+  server_thread_.join();
+}
+
+dpp::async<dpp::confirmation_callback_t> FakeRestBackend::Request(std::string const& route,
+                                                                  std::function<void(dpp::confirmation_callback_t&)> const handler) noexcept {
+  return dpp::async<dpp::confirmation_callback_t>{[this, route, handler](auto&& callback){
+    {
+      std::lock_guard<std::mutex> const mutex_lock_guard(backend_mutex_);
+      auto const now = std::chrono::steady_clock::now();
+
+      Response response;
+      response.delivery_time = now + latency_;
+      response.result.http_info = Answer(route, now);
+      if ((kOkStatus == response.result.http_info.status) && handler) {
+        handler(response.result);
+      }
+      response.callback = std::forward<decltype(callback)>(callback);
+      responses_.push(std::move(response));
+    }
+
+    backend_condition_variable_.notify_one();
+  }};
+}
+
+size_t FakeRestBackend::GetRequests() const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(backend_mutex_);
+  return requests_;
+}
+
+size_t FakeRestBackend::GetTooManyRequests() const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(backend_mutex_);
+  return too_many_requests_;
+}
+
+dpp::http_request_completion_t FakeRestBackend::Answer(std::string const& route, std::chrono::steady_clock::time_point const now) noexcept {
+  ++requests_;
+
+  for (auto* const window : {&global_window_, &routes_windows_[route]}) {
+    if (window->reset_time <= now) {
+      window->used = 0;
+      window->reset_time = now + kWindow;
+    }
+  }
+
+  auto& route_window = routes_windows_[route];
+  dpp::http_request_completion_t http_info;
+  if ((global_window_.used >= global_limit_) || (route_window.used >= route_limit_)) {
+    ++too_many_requests_;
+
+    auto const global = global_window_.used >= global_limit_;
+    http_info.status = kTooManyRequestsStatus;
+    http_info.ratelimit_global = global;
+    http_info.ratelimit_retry_after = ::GetSecondsUntil(now, global ? global_window_.reset_time : route_window.reset_time);
+    return http_info;
+  }
+
+  ++global_window_.used;
+  ++route_window.used;
+
+  http_info.status = kOkStatus;
+  http_info.ratelimit_limit = route_limit_;
+  http_info.ratelimit_remaining = route_limit_ - route_window.used;
+  http_info.ratelimit_reset_after = ::GetSecondsUntil(now, route_window.reset_time);
+  return http_info;
+}
+
+void FakeRestBackend::Serve() noexcept {
+  std::unique_lock<std::mutex> mutex_unique_lock(backend_mutex_);
+  while (running_) {
+    if (responses_.empty()) {
+      backend_condition_variable_.wait(mutex_unique_lock);
+      continue;
+    }
+
+    // Latency is fixed so responses are due in the order the requests came in
+    if (std::chrono::steady_clock::now() < responses_.front().delivery_time) {
+      backend_condition_variable_.wait_until(mutex_unique_lock, responses_.front().delivery_time);
+      continue;
+    }
+
+    auto response = std::move(responses_.front());
+    responses_.pop();
+
+    mutex_unique_lock.unlock();
+    response.callback(response.result);
+    mutex_unique_lock.lock();
+  }
+}
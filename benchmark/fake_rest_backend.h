@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <dpp/dpp.h>
+
+// Stands in for Discord's REST API so the REST budgeter can be exercised offline. Every route allows route_limit
+// requests per second and all routes together global_limit, responses arrive after a fixed latency carrying the same
+// rate limit headers Discord sends, and requests over a limit are answered with a 429.
+class FakeRestBackend final {
+public:
+  FakeRestBackend() = delete;
+  ~FakeRestBackend();
+
+  FakeRestBackend(uint64_t route_limit, uint64_t global_limit, std::chrono::milliseconds latency);
+
+  // The handler fills in the payload and only runs for requests within the limits, under the backend's lock
+  dpp::async<dpp::confirmation_callback_t> Request(std::string const& route,
+                                                   std::function<void(dpp::confirmation_callback_t&)> handler = {}) noexcept;
+
+  size_t GetRequests() const noexcept;
+  size_t GetTooManyRequests() const noexcept;
+
+private:
+  struct Window final {
+    uint64_t used = {};
+    std::chrono::steady_clock::time_point reset_time = {};
+  };
+
+  struct Response final {
+    std::chrono::steady_clock::time_point delivery_time = {};
+    dpp::confirmation_callback_t result;
+    std::function<void(dpp::confirmation_callback_t const&)> callback;
+  };
+
+  dpp::http_request_completion_t Answer(std::string const& route, std::chrono::steady_clock::time_point now) noexcept;
+
+  void Serve() noexcept;
+
+private:
+  uint64_t const route_limit_ = {};
+  uint64_t const global_limit_ = {};
+  std::chrono::milliseconds const latency_ = {};
+
+  mutable std::mutex backend_mutex_;
+  std::condition_variable backend_condition_variable_;
+  bool running_ = true;
+
+  Window global_window_;
+  std::unordered_map<std::string, Window> routes_windows_;
+  std::queue<Response> responses_;
+  size_t requests_ = {};
+  size_t too_many_requests_ = {};
+
+  std::thread server_thread_;
+};
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <dpp/dpp.h>
+
+#include "pokatto_prestige/leaderboard/leaderboard.h"
+#include "pokatto_prestige/leaderboard/monthly_points.h"
+
+namespace {
+  auto constexpr kFirstUserId = 100000000000000000ULL;
+  // 2024-01-01T00:00:00Z
+  auto constexpr kYearStartTimestamp = std::time_t{1704067200};
+
+  std::vector<std::pair<dpp::snowflake, size_t>> GetRatings(size_t const users, size_t const ratings) noexcept {
+    std::mt19937_64 random_engine(users);
+    std::uniform_int_distribution<uint64_t> user_distribution(0, users - 1);
+    std::uniform_int_distribution<size_t> rating_distribution(0, 9);
+
+    std::vector<std::pair<dpp::snowflake, size_t>> user_ratings;
+    user_ratings.reserve(ratings);
+    for (size_t rating = 0; rating < ratings; ++rating) {
+      user_ratings.emplace_back(kFirstUserId + user_distribution(random_engine), rating_distribution(random_engine));
+    }
+
+    return user_ratings;
+  }
+
+  Leaderboard GetLeaderboard(size_t const users) noexcept {
+    Leaderboard leaderboard;
+    for (auto const& [user_id, rating] : ::GetRatings(users, users * 4)) {
+      leaderboard.Increment(user_id, rating);
+    }
+
+    return leaderboard;
+  }
+
+  // The std::list leaderboard Leaderboard replaced, kept as the baseline to compare against
+  size_t IncrementListLeaderboard(std::list<std::pair<dpp::snowflake, size_t>>& pokattos_points, dpp::snowflake const user_id, size_t const rating) noexcept {
+    auto it_pokatto_points = std::find_if(pokattos_points.begin(), pokattos_points.end(),
+                                          [user_id](std::pair<dpp::snowflake, size_t> const& pokatto_points){ return pokatto_points.first == user_id; });
+    if (it_pokatto_points == pokattos_points.cend()) {
+      pokattos_points.emplace_back(user_id, rating);
+      return rating;
+    }
+
+    it_pokatto_points->second += rating;
+    return it_pokatto_points->second;
+  }
+}
+
+static void BM_LeaderboardIncrement(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto leaderboard = ::GetLeaderboard(users);
+  auto const ratings = ::GetRatings(users, 1 << 16);
+
+  size_t rating{};
+  for (auto _ : state) {
+    auto const& [user_id, points] = ratings[rating++ & (ratings.size() - 1)];
+    benchmark::DoNotOptimize(leaderboard.Increment(user_id, points));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LeaderboardIncrement)->RangeMultiplier(10)->Range(100, 1000000);
+
+static void BM_LeaderboardGetRank(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto const leaderboard = ::GetLeaderboard(users);
+  auto const ratings = ::GetRatings(users, 1 << 16);
+
+  size_t rating{};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(leaderboard.GetRank(ratings[rating++ & (ratings.size() - 1)].first));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LeaderboardGetRank)->RangeMultiplier(10)->Range(100, 1000000);
+
+static void BM_LeaderboardTop(benchmark::State& state) {
+  auto const leaderboard = ::GetLeaderboard(1000000);
+  auto const count = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    size_t points{};
+    leaderboard.ForEach(count, [&points](dpp::snowflake const user_id, size_t const user_points){ points += user_points; });
+    benchmark::DoNotOptimize(points);
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_LeaderboardTop)->RangeMultiplier(10)->Range(10, 1000000);
+
+static void BM_ListLeaderboardIncrementAndSort(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  std::list<std::pair<dpp::snowflake, size_t>> leaderboard;
+  for (auto const& [user_id, rating] : ::GetRatings(users, users * 4)) {
+    ::IncrementListLeaderboard(leaderboard, user_id, rating);
+  }
+  auto const ratings = ::GetRatings(users, 1 << 16);
+
+  size_t rating{};
+  for (auto _ : state) {
+    auto const& [user_id, points] = ratings[rating++ & (ratings.size() - 1)];
+    benchmark::DoNotOptimize(::IncrementListLeaderboard(leaderboard, user_id, points));
+    leaderboard.sort([](std::pair<dpp::snowflake, size_t> const& lhs, std::pair<dpp::snowflake, size_t> const& rhs){ return lhs.second > rhs.second; });
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ListLeaderboardIncrementAndSort)->RangeMultiplier(10)->Range(100, 100000);
+
+static void BM_MonthlyPointsYearToDate(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto const ratings = ::GetRatings(users, users * 4);
+
+  // Ratings are spread evenly over the year, the board sums every month's bucket
+  MonthlyPoints monthly_points(std::chrono::minutes(0));
+  auto const rating_interval = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::years(1)).count() / static_cast<std::time_t>(ratings.size());
+  for (size_t rating = 0; rating < ratings.size(); ++rating) {
+    auto const& [user_id, points] = ratings[rating];
+    monthly_points.Increment(user_id, kYearStartTimestamp + static_cast<std::time_t>(rating) * rating_interval, points);
+  }
+  auto const current_month = monthly_points.GetMonth(kYearStartTimestamp);
+
+  for (auto _ : state) {
+    auto const leaderboard = monthly_points.GetLeaderboard(current_month.year() / std::chrono::January, current_month.year() / std::chrono::December);
+    benchmark::DoNotOptimize(leaderboard.GetSize());
+  }
+
+  state.SetItemsProcessed(state.iterations() * ratings.size());
+}
+BENCHMARK(BM_MonthlyPointsYearToDate)->RangeMultiplier(10)->Range(100, 100000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,144 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <dpp/dpp.h>
+#include <fmt/format.h>
+
+#include "pokatto_prestige/leaderboard/leaderboard.h"
+#include "pokatto_prestige/leaderboard/leaderboard_render_cache.h"
+#include "pokatto_prestige/leaderboard/leaderboard_renderer.h"
+#include "pokatto_prestige/pages/page_builder.h"
+#include "pokatto_prestige/usernames/username_cache.h"
+
+namespace {
+  auto constexpr kFirstUserId = 100000000000000000ULL;
+  auto constexpr kBenchmarkDirectory = "pokatto_prestige_benchmark";
+  auto constexpr kUsernameCacheTtl = std::chrono::hours(168);
+
+  Leaderboard GetLeaderboard(size_t const users) noexcept {
+    std::mt19937_64 random_engine(users);
+    std::uniform_int_distribution<size_t> points_distribution(1, 500);
+
+    Leaderboard leaderboard;
+    for (size_t user = 0; user < users; ++user) {
+      leaderboard.Increment(kFirstUserId + user, points_distribution(random_engine));
+    }
+
+    return leaderboard;
+  }
+
+  void UpdateUsernames(UsernameCache& usernames_cache, size_t const users) noexcept {
+    for (size_t user = 0; user < users; ++user) {
+      usernames_cache.Update(kFirstUserId + user, "pokatto_" + std::to_string(user));
+    }
+  }
+
+  // The queue of lines PageBuilder replaced, kept as the baseline to compare against
+  void RenderQueuePages(std::string& message, std::queue<std::string>& entries, std::vector<std::string>& pages) noexcept {
+    while (!entries.empty()) {
+      while (!entries.empty() && (message.length() + entries.front().length()) <= PageBuilder::kMaxPageLength) {
+        message.append(entries.front());
+        entries.pop();
+      }
+      pages.push_back(message);
+
+      message.clear();
+    }
+  }
+}
+
+static void BM_LeaderboardRendererRenderEntries(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto const leaderboard = ::GetLeaderboard(users);
+
+  // The cache persists to the working directory, so it is made from a scratch one
+  auto const working_directory = std::filesystem::current_path();
+  auto const benchmark_directory = std::filesystem::temp_directory_path() / kBenchmarkDirectory;
+  std::filesystem::create_directories(benchmark_directory);
+  std::filesystem::current_path(benchmark_directory);
+  UsernameCache usernames_cache(kUsernameCacheTtl);
+  std::filesystem::current_path(working_directory);
+  ::UpdateUsernames(usernames_cache, users);
+
+  for (auto _ : state) {
+    PageBuilder page_builder;
+    page_builder.AppendLine("**Full Pokatto Prestige Leaderboard:**\n");
+    LeaderboardRenderer::RenderEntries(leaderboard, usernames_cache, page_builder);
+    benchmark::DoNotOptimize(page_builder.GetPages().size());
+  }
+
+  state.SetItemsProcessed(state.iterations() * users);
+}
+BENCHMARK(BM_LeaderboardRendererRenderEntries)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_LeaderboardRenderCacheRender(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto leaderboard = ::GetLeaderboard(users);
+
+  auto const working_directory = std::filesystem::current_path();
+  auto const benchmark_directory = std::filesystem::temp_directory_path() / kBenchmarkDirectory;
+  std::filesystem::create_directories(benchmark_directory);
+  std::filesystem::current_path(benchmark_directory);
+  UsernameCache usernames_cache(kUsernameCacheTtl);
+  std::filesystem::current_path(working_directory);
+  ::UpdateUsernames(usernames_cache, users);
+
+  std::string const title = "**Full Pokatto Prestige Leaderboard:**\n";
+  LeaderboardRenderCache render_cache;
+  render_cache.Render(leaderboard, usernames_cache, title);
+
+  // Every refresh follows one rating of a random user, as the bot's do
+  std::mt19937_64 random_engine(users);
+  std::uniform_int_distribution<size_t> user_distribution(0, users - 1);
+  std::uniform_int_distribution<size_t> rating_distribution(1, 9);
+  for (auto _ : state) {
+    dpp::snowflake const user_id = kFirstUserId + user_distribution(random_engine);
+    leaderboard.Increment(user_id, rating_distribution(random_engine));
+    render_cache.Invalidate(user_id);
+    benchmark::DoNotOptimize(render_cache.Render(leaderboard, usernames_cache, title).size());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LeaderboardRenderCacheRender)->RangeMultiplier(10)->Range(100, 1000000);
+
+static void BM_PageBuilderGetPages(benchmark::State& state) {
+  auto const entries = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    PageBuilder page_builder;
+    page_builder.AppendLine("**Full Pokatto Prestige Leaderboard:**\n");
+    for (size_t entry = 0; entry < entries; ++entry) {
+      page_builder.AppendLine("{} points: <@{}> - (pokatto_{})\n", entries - entry, kFirstUserId + entry, entry);
+    }
+    benchmark::DoNotOptimize(page_builder.GetPages().size());
+  }
+
+  state.SetItemsProcessed(state.iterations() * entries);
+}
+BENCHMARK(BM_PageBuilderGetPages)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_QueueRenderPages(benchmark::State& state) {
+  auto const entries = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    std::queue<std::string> leaderboard_entries;
+    for (size_t entry = 0; entry < entries; ++entry) {
+      leaderboard_entries.push(fmt::format("{} points: <@{}> - (pokatto_{})\n", entries - entry, kFirstUserId + entry, entry));
+    }
+
+    std::vector<std::string> leaderboard_pages;
+    std::string leaderboard_message = "**Full Pokatto Prestige Leaderboard:**\n";
+    ::RenderQueuePages(leaderboard_message, leaderboard_entries, leaderboard_pages);
+    benchmark::DoNotOptimize(leaderboard_pages.size());
+  }
+
+  state.SetItemsProcessed(state.iterations() * entries);
+}
+BENCHMARK(BM_QueueRenderPages)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
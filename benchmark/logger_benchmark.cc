@@ -0,0 +1,84 @@
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+#include <spdlog/async.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include "logger/logger.h"
+
+namespace {
+  auto constexpr kMessageId = 1234567890123456789ULL;
+  auto constexpr kUserId = 987654321098765432ULL;
+
+  // Discards what it is given, so only the calling thread's cost and the queueing are measured
+  std::shared_ptr<spdlog::async_logger> CreateAsyncLogger(spdlog::level::level_enum const level) {
+    static auto const thread_pool = std::make_shared<spdlog::details::thread_pool>(8192, 1);
+
+    auto logger = std::make_shared<spdlog::async_logger>("benchmark", std::make_shared<spdlog::sinks::null_sink_mt>(), thread_pool,
+                                                         spdlog::async_overflow_policy::overrun_oldest);
+    logger->set_level(level);
+
+    return logger;
+  }
+}
+
+static void BM_LoggerEnabled(benchmark::State& state) {
+  Logger const logger(::CreateAsyncLogger(spdlog::level::info));
+
+  for (auto _ : state) {
+    logger.Info("Processing rating. Message id: '{}'. Rating: '{}'. User id: '{}'", kMessageId, 7, kUserId);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerEnabled);
+
+// The Logger before the level check, formatting into a string whatever the level, kept as the baseline to compare against
+static void BM_EagerLoggerEnabled(benchmark::State& state) {
+  auto const logger = ::CreateAsyncLogger(spdlog::level::info);
+
+  for (auto _ : state) {
+    auto const message = fmt::format("Processing rating. Message id: '{}'. Rating: '{}'. User id: '{}'", kMessageId, 7, kUserId);
+    logger->info(message);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EagerLoggerEnabled);
+
+static void BM_LoggerDisabled(benchmark::State& state) {
+  Logger const logger(::CreateAsyncLogger(spdlog::level::warn));
+
+  for (auto _ : state) {
+    logger.Info("Processing rating. Message id: '{}'. Rating: '{}'. User id: '{}'", kMessageId, 7, kUserId);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerDisabled);
+
+static void BM_EagerLoggerDisabled(benchmark::State& state) {
+  auto const logger = ::CreateAsyncLogger(spdlog::level::warn);
+
+  for (auto _ : state) {
+    auto const message = fmt::format("Processing rating. Message id: '{}'. Rating: '{}'. User id: '{}'", kMessageId, 7, kUserId);
+    logger->info(message);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EagerLoggerDisabled);
+
+// Compiled out unless SPDLOG_ACTIVE_LEVEL is TRACE, in which case it is filtered at runtime like BM_LoggerDisabled
+static void BM_LoggerCompiledOut(benchmark::State& state) {
+  Logger const logger(::CreateAsyncLogger(spdlog::level::info));
+
+  for (auto _ : state) {
+    logger.Trace("Processing rating. Message id: '{}'. Rating: '{}'. User id: '{}'", kMessageId, 7, kUserId);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoggerCompiledOut);
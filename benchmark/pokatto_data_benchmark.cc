@@ -0,0 +1,189 @@
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <benchmark/benchmark.h>
+#include <dpp/dpp.h>
+#include <nlohmann/json.hpp>
+
+#include "pokatto_prestige/pokatto/pokatto_data.h"
+#include "pokatto_prestige/pokatto/pokattos_data.h"
+
+namespace {
+  auto constexpr kFirstUserId = 100000000000000000ULL;
+  auto constexpr kBenchmarkDirectory = "pokatto_prestige_benchmark";
+  auto constexpr kRewardsKeys = std::array{"special_discord_role", "chaos_cat_doodle", "pokattosona", "vip_on_twitch", "store_merch", "clay_pokatto"};
+
+  std::vector<std::pair<dpp::snowflake, uint64_t>> GetUnlockedRewards(size_t const users) noexcept {
+    std::mt19937_64 random_engine(users);
+    std::uniform_int_distribution<uint64_t> mask_distribution(0, (1ULL << static_cast<size_t>(Settings::Rewards::kEnd)) - 1);
+
+    std::vector<std::pair<dpp::snowflake, uint64_t>> unlocked_rewards;
+    unlocked_rewards.reserve(users);
+    for (size_t user = 0; user < users; ++user) {
+      unlocked_rewards.emplace_back(kFirstUserId + user, mask_distribution(random_engine) & ~1ULL);
+    }
+
+    return unlocked_rewards;
+  }
+
+  // Writes one file per user the way rewards were stored before the ledger, reused across runs when complete
+  std::filesystem::path GetDataDirectory(size_t const users) {
+    auto const benchmark_directory = std::filesystem::temp_directory_path() / kBenchmarkDirectory / std::to_string(users);
+    auto const data_directory = benchmark_directory / "data";
+    if (std::filesystem::exists(data_directory) &&
+        (users == static_cast<size_t>(std::distance(std::filesystem::directory_iterator(data_directory), std::filesystem::directory_iterator())))) {
+      return benchmark_directory;
+    }
+
+    std::filesystem::remove_all(data_directory);
+    std::filesystem::create_directories(data_directory);
+    for (auto const& [user_id, unlocked_rewards_mask] : ::GetUnlockedRewards(users)) {
+      nlohmann::json pokatto_data_json;
+      size_t reward = static_cast<size_t>(Settings::Rewards::kBegin);
+      for (auto const reward_key : kRewardsKeys) {
+        pokatto_data_json["unlocked_rewards"][reward_key] = (0 != (unlocked_rewards_mask & (1ULL << reward++)));
+      }
+
+      std::ofstream(data_directory / (std::to_string(user_id) + ".json")) << pokatto_data_json;
+    }
+
+    return benchmark_directory;
+  }
+
+  size_t GetHeapBytes() noexcept {
+#ifdef __GLIBC__
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+  }
+
+  // The std::map of std::map layout PokattosData replaced, kept as the baseline to compare against
+  std::map<dpp::snowflake, std::map<Settings::Rewards, bool>> GetMapPokattosData(std::vector<std::pair<dpp::snowflake, uint64_t>> const& unlocked_rewards) noexcept {
+    std::map<dpp::snowflake, std::map<Settings::Rewards, bool>> pokattos_data;
+    for (auto const& [user_id, unlocked_rewards_mask] : unlocked_rewards) {
+      auto& pokatto_rewards = pokattos_data[user_id];
+      for (size_t reward = static_cast<size_t>(Settings::Rewards::kBegin); reward < static_cast<size_t>(Settings::Rewards::kEnd); ++reward) {
+        pokatto_rewards[static_cast<Settings::Rewards>(reward)] = (0 != (unlocked_rewards_mask & (1ULL << reward)));
+      }
+    }
+
+    return pokattos_data;
+  }
+}
+
+static void BM_ReadPokattosData(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto const working_directory = std::filesystem::current_path();
+  std::filesystem::current_path(::GetDataDirectory(users));
+
+  size_t heap_bytes{};
+  for (auto _ : state) {
+    auto const heap_bytes_before = ::GetHeapBytes();
+    PokattosData pokattos_data;
+    pokattos_data.Assign(PokattoData::ReadPokattosData());
+    heap_bytes = ::GetHeapBytes() - heap_bytes_before;
+    benchmark::DoNotOptimize(pokattos_data.GetSize());
+  }
+
+  std::filesystem::current_path(working_directory);
+
+  state.counters["heap_bytes"] = static_cast<double>(heap_bytes);
+  state.SetItemsProcessed(state.iterations() * users);
+}
+BENCHMARK(BM_ReadPokattosData)->RangeMultiplier(10)->Range(100, 100000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_AssignPokattosData(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto const unlocked_rewards = ::GetUnlockedRewards(users);
+
+  size_t heap_bytes{};
+  for (auto _ : state) {
+    auto const heap_bytes_before = ::GetHeapBytes();
+    std::vector<PokattoData> loaded_pokattos_data;
+    loaded_pokattos_data.reserve(unlocked_rewards.size());
+    for (auto const& [user_id, unlocked_rewards_mask] : unlocked_rewards) {
+      loaded_pokattos_data.emplace_back(user_id, unlocked_rewards_mask);
+    }
+
+    PokattosData pokattos_data;
+    pokattos_data.Assign(std::move(loaded_pokattos_data));
+    heap_bytes = ::GetHeapBytes() - heap_bytes_before;
+    benchmark::DoNotOptimize(pokattos_data.GetSize());
+  }
+
+  state.counters["heap_bytes"] = static_cast<double>(heap_bytes);
+  state.SetItemsProcessed(state.iterations() * users);
+}
+BENCHMARK(BM_AssignPokattosData)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_AssignMapPokattosData(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto const unlocked_rewards = ::GetUnlockedRewards(users);
+
+  size_t heap_bytes{};
+  for (auto _ : state) {
+    auto const heap_bytes_before = ::GetHeapBytes();
+    auto const pokattos_data = ::GetMapPokattosData(unlocked_rewards);
+    heap_bytes = ::GetHeapBytes() - heap_bytes_before;
+    benchmark::DoNotOptimize(pokattos_data.size());
+  }
+
+  state.counters["heap_bytes"] = static_cast<double>(heap_bytes);
+  state.SetItemsProcessed(state.iterations() * users);
+}
+BENCHMARK(BM_AssignMapPokattosData)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond);
+
+static void BM_PokattosDataFind(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  std::vector<PokattoData> loaded_pokattos_data;
+  for (auto const& [user_id, unlocked_rewards_mask] : ::GetUnlockedRewards(users)) {
+    loaded_pokattos_data.emplace_back(user_id, unlocked_rewards_mask);
+  }
+  PokattosData pokattos_data;
+  pokattos_data.Assign(std::move(loaded_pokattos_data));
+
+  std::mt19937_64 random_engine(users);
+  std::uniform_int_distribution<uint64_t> user_distribution(0, users - 1);
+  for (auto _ : state) {
+    auto const pokatto_data = pokattos_data.Find(kFirstUserId + user_distribution(random_engine));
+    benchmark::DoNotOptimize(pokatto_data->IsRewardUnlocked(Settings::Rewards::kPokattosona));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PokattosDataFind)->RangeMultiplier(10)->Range(100, 1000000);
+
+static void BM_GetUnlockableRewards(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  std::vector<PokattoData> loaded_pokattos_data;
+  for (auto const& [user_id, unlocked_rewards_mask] : ::GetUnlockedRewards(users)) {
+    loaded_pokattos_data.emplace_back(user_id, unlocked_rewards_mask);
+  }
+  PokattosData pokattos_data;
+  pokattos_data.Assign(std::move(loaded_pokattos_data));
+
+  auto constexpr rewards_prices = Settings::RewardsPrices{0, 50, 100, 250, 500, 1000, 2500};
+
+  // Looks the rating user up and checks which rewards its new total unlocks, as every rating does
+  std::mt19937_64 random_engine(users);
+  std::uniform_int_distribution<uint64_t> user_distribution(0, users - 1);
+  std::uniform_int_distribution<size_t> points_distribution(0, 3000);
+  for (auto _ : state) {
+    auto const pokatto_data = pokattos_data.Find(kFirstUserId + user_distribution(random_engine));
+    benchmark::DoNotOptimize(pokatto_data->GetUnlockableRewards(points_distribution(random_engine), rewards_prices));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetUnlockableRewards)->RangeMultiplier(10)->Range(100, 1000000);
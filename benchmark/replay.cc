@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <argparse/argparse.hpp>
+#include <dpp/dpp.h>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "fake_discord_client.h"
+#include "logger/logger_factory.h"
+#include "metrics/histogram.h"
+#include "pokatto_prestige/pokatto_prestige.h"
+#include "pokatto_prestige/scheduler/rest_budgeter.h"
+
+// Replays reaction and slash command events against Pokatto Prestige running on a fake Discord, and reports the
+// throughput and the latency from each rating reaction to the bot's processed reaction. Events are synthesised or
+// read from a JSON lines file, one event per line:
+//   {"offset_ms": 1200, "type": "reaction", "message_id": 1, "channel_id": 11, "author_id": 100, "emoji": "5️⃣"}
+//   {"offset_ms": 1400, "type": "reaction_remove", "message_id": 1, "channel_id": 11, "emoji": "5️⃣"}
+//   {"offset_ms": 1500, "type": "get_points_history", "user_id": 100}
+// Reactions are always SquChan's, their messages are added to the fake before the replay starts. Removals and reactions
+// on messages already rated change ratings without a processed reaction, so they aren't timed.
+
+namespace {
+  auto constexpr kReplayDirectory = "pokatto_prestige_replay";
+  auto constexpr kBotUserId = 1ULL;
+  auto constexpr kSquchanUserId = 2ULL;
+  auto constexpr kFolleUserId = 3ULL;
+  auto constexpr kServerId = 4ULL;
+  auto constexpr kLeaderboardChannelId = 5ULL;
+  auto constexpr kThreadsIds = std::array{11ULL, 12ULL, 13ULL, 14ULL, 15ULL};
+  auto constexpr kThreadsKeys = std::array{"fanarts", "memes", "thumbnails", "video_edits", "youtube_clips"};
+  auto constexpr kRewardsKeys = std::array{"special_discord_role", "chaos_cat_doodle", "pokattosona", "vip_on_twitch", "store_merch", "clay_pokatto"};
+  auto constexpr kRewardsPrices = std::array{10ULL, 25ULL, 50ULL, 100ULL, 250ULL, 500ULL};
+  auto constexpr kFirstUserId = 100000000000000000ULL;
+  auto constexpr kRatingEmojis = std::array<std::string_view, 10>{"x_", "1️⃣", "2️⃣", "3️⃣", "4️⃣", "5️⃣", "6️⃣", "7️⃣", "8️⃣", "9️⃣"};
+  auto constexpr kProcessedMessageEmoji = "✅";
+  auto constexpr kReactionEventType = "reaction";
+  auto constexpr kReactionRemoveEventType = "reaction_remove";
+  auto constexpr kPointsHistoryEventType = "get_points_history";
+  auto constexpr kSubmissionsAge = std::chrono::hours(24);
+
+  struct Options final {
+    int users = 1000;
+    int submissions = 5000;
+    int reactions = 2000;
+    int points_histories = 20;
+    double duration_seconds = 60.0;
+    double speed = 10.0;
+    int latency_ms = 50;
+    int route_limit = 5;
+    int global_limit = 50;
+    int leaderboard_update_interval_seconds = 1;
+    int timeout_seconds = 120;
+    std::string events_path;
+  };
+
+  struct ReplayEvent final {
+    enum class Type {
+      kReaction,
+      kReactionRemove,
+      kPointsHistory
+    };
+
+    std::chrono::milliseconds offset = {};
+    Type type = Type::kReaction;
+    dpp::snowflake message_id = {};
+    dpp::snowflake channel_id = {};
+    dpp::snowflake user_id = {};
+    std::string emoji;
+  };
+
+  void ParseArguments(int const argc, char const *const *const argv, Options& options) {
+    argparse::ArgumentParser argument_parser("Pokatto Prestige Replay", "1.0");
+
+    argument_parser.add_argument("--users").help("Synthetic users posting submissions").store_into(options.users);
+    argument_parser.add_argument("--submissions").help("Synthetic submissions posted before the replay").store_into(options.submissions);
+    argument_parser.add_argument("--reactions").help("Synthetic rating reactions, each on its own submission").store_into(options.reactions);
+    argument_parser.add_argument("--points_histories").help("Synthetic get_points_history slash commands").store_into(options.points_histories);
+    argument_parser.add_argument("--duration_seconds").help("Time the synthetic events are spread over").store_into(options.duration_seconds);
+    argument_parser.add_argument("--speed").help("Replay speed, 10 replays a minute of events in 6 seconds").store_into(options.speed);
+    argument_parser.add_argument("--latency_ms").help("Latency of every fake REST call").store_into(options.latency_ms);
+    argument_parser.add_argument("--route_limit").help("Fake requests per second allowed on each route").store_into(options.route_limit);
+    argument_parser.add_argument("--global_limit").help("Fake requests per second allowed across all routes").store_into(options.global_limit);
+    argument_parser.add_argument("--leaderboard_update_interval_seconds").help("Leaderboard update interval setting").store_into(options.leaderboard_update_interval_seconds);
+    argument_parser.add_argument("--timeout_seconds").help("Time to wait for the ratings once every event is replayed").store_into(options.timeout_seconds);
+    argument_parser.add_argument("--events").help("JSON lines file of recorded events, replayed instead of synthetic ones").store_into(options.events_path);
+
+    argument_parser.parse_args(argc, argv);
+
+    if ((options.users <= 0) || (options.submissions < options.reactions) || (options.speed <= 0.0)) {
+      throw std::runtime_error("Users and speed must be positive, and there must be a submission for every reaction");
+    }
+  }
+
+  void StoreSettings(Options const& options) {
+    nlohmann::json settings_json;
+    settings_json["bot_token"] = "";
+    settings_json["bot_user_id"] = kBotUserId;
+    settings_json["squchan_user_id"] = kSquchanUserId;
+    settings_json["folle_user_id"] = kFolleUserId;
+    settings_json["server_id"] = kServerId;
+    settings_json["pokatto_prestige_path_channel_id"] = kLeaderboardChannelId;
+    for (size_t thread = 0; thread < kThreadsIds.size(); ++thread) {
+      settings_json["submission_threads_ids"][kThreadsKeys[thread]] = kThreadsIds[thread];
+    }
+    for (size_t reward = 0; reward < kRewardsPrices.size(); ++reward) {
+      settings_json["rewards_prices"][kRewardsKeys[reward]] = kRewardsPrices[reward];
+    }
+    settings_json["leaderboard_update_interval_seconds"] = options.leaderboard_update_interval_seconds;
+    settings_json["username_cache_ttl_hours"] = 168;
+    settings_json["prefetch_guild_members"] = false;
+
+    std::filesystem::create_directories("settings");
+    std::ofstream("settings/settings.json") << settings_json.dump(2);
+  }
+
+  // Submissions are posted over the last day so they all fall in the current month's leaderboard on most days
+  std::vector<ReplayEvent> GetSyntheticEvents(Options const& options, FakeDiscordClient& fake_discord_client) noexcept {
+    std::mt19937_64 random_engine(static_cast<uint64_t>(options.submissions));
+    std::uniform_int_distribution<size_t> user_distribution(0, static_cast<size_t>(options.users) - 1);
+    std::uniform_int_distribution<size_t> thread_distribution(0, kThreadsIds.size() - 1);
+    std::uniform_int_distribution<size_t> emoji_distribution(0, kRatingEmojis.size() - 1);
+    std::uniform_int_distribution<int64_t> offset_distribution(0, static_cast<int64_t>(options.duration_seconds * 1000.0));
+
+    for (int user = 0; user < options.users; ++user) {
+      fake_discord_client.AddUser(kFirstUserId + user, fmt::format("pokatto_{}", user));
+    }
+
+    auto const first_submission_time = std::chrono::system_clock::now() - kSubmissionsAge;
+    auto const submission_interval = kSubmissionsAge / options.submissions;
+    std::vector<ReplayEvent> submissions;
+    submissions.reserve(static_cast<size_t>(options.submissions));
+    for (int submission = 0; submission < options.submissions; ++submission) {
+      auto const message_id = FakeDiscordClient::GetSnowflake(first_submission_time + (submission * submission_interval), submission);
+      auto const channel_id = kThreadsIds[thread_distribution(random_engine)];
+      auto const author_id = kFirstUserId + user_distribution(random_engine);
+      fake_discord_client.AddMessage(message_id, channel_id, author_id);
+      submissions.push_back({{}, ReplayEvent::Type::kReaction, message_id, channel_id, author_id, {}});
+    }
+
+    std::shuffle(submissions.begin(), submissions.end(), random_engine);
+
+    std::vector<ReplayEvent> events;
+    events.reserve(static_cast<size_t>(options.reactions + options.points_histories));
+    for (int reaction = 0; reaction < options.reactions; ++reaction) {
+      auto& event = submissions[reaction];
+      event.offset = std::chrono::milliseconds(offset_distribution(random_engine));
+      event.emoji = kRatingEmojis[emoji_distribution(random_engine)];
+      events.push_back(event);
+    }
+
+    for (int points_history = 0; points_history < options.points_histories; ++points_history) {
+      events.push_back({std::chrono::milliseconds(offset_distribution(random_engine)), ReplayEvent::Type::kPointsHistory, {}, {},
+                        kFirstUserId + user_distribution(random_engine), {}});
+    }
+
+    std::sort(events.begin(), events.end(), [](auto const& lhs, auto const& rhs){ return lhs.offset < rhs.offset; });
+
+    return events;
+  }
+
+  std::vector<ReplayEvent> ReadEvents(std::filesystem::path const& events_path, FakeDiscordClient& fake_discord_client) {
+    std::ifstream events_file(events_path);
+    if (!events_file) {
+      throw std::runtime_error(fmt::format("Failed to open events file: '{}'", events_path.string()));
+    }
+
+    std::vector<ReplayEvent> events;
+    std::string event_line;
+    while (std::getline(events_file, event_line)) {
+      if (event_line.empty()) {
+        continue;
+      }
+
+      auto const event_json = nlohmann::json::parse(event_line);
+      auto const offset = std::chrono::milliseconds(event_json["offset_ms"].get<int64_t>());
+      auto const type = event_json["type"].get<std::string>();
+      if (kReactionEventType == type) {
+        auto const message_id = event_json["message_id"].get<uint64_t>();
+        auto const channel_id = event_json["channel_id"].get<uint64_t>();
+        auto const author_id = event_json["author_id"].get<uint64_t>();
+        fake_discord_client.AddUser(author_id, fmt::format("pokatto_{}", author_id));
+        fake_discord_client.AddMessage(message_id, channel_id, author_id);
+        events.push_back({offset, ReplayEvent::Type::kReaction, message_id, channel_id, author_id, event_json["emoji"].get<std::string>()});
+      } else if (kReactionRemoveEventType == type) {
+        events.push_back({offset, ReplayEvent::Type::kReactionRemove, event_json["message_id"].get<uint64_t>(), event_json["channel_id"].get<uint64_t>(),
+                          {}, event_json["emoji"].get<std::string>()});
+      } else if (kPointsHistoryEventType == type) {
+        events.push_back({offset, ReplayEvent::Type::kPointsHistory, {}, {}, event_json["user_id"].get<uint64_t>(), {}});
+      } else {
+        throw std::runtime_error(fmt::format("Unknown event type: '{}'", type));
+      }
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](auto const& lhs, auto const& rhs){ return lhs.offset < rhs.offset; });
+
+    return events;
+  }
+
+  double GetMilliseconds(std::chrono::microseconds const duration) noexcept {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+
+  int Replay(Options const& options, std::filesystem::path const& events_path) {
+    // The bot keeps its settings and state in the working directory, every replay starts from an empty one
+    auto const replay_directory = std::filesystem::temp_directory_path() / kReplayDirectory;
+    std::filesystem::remove_all(replay_directory);
+    std::filesystem::create_directories(replay_directory);
+    std::filesystem::current_path(replay_directory);
+    ::StoreSettings(options);
+
+    LoggerFactory::Get().SetStdoutLevel(spdlog::level::warn);
+
+    auto const fake_discord_client = std::make_shared<FakeDiscordClient>(kBotUserId, options.route_limit, options.global_limit,
+                                                                         std::chrono::milliseconds(options.latency_ms));
+    fake_discord_client->AddUser(kSquchanUserId, "squchan");
+    auto const events = events_path.empty() ? ::GetSyntheticEvents(options, *fake_discord_client) : ::ReadEvents(events_path, *fake_discord_client);
+
+    // Only the first reaction on a message is rated, so that is the one the processed reaction is timed from
+    std::mutex replay_mutex;
+    std::condition_variable replay_condition_variable;
+    std::unordered_map<dpp::snowflake, std::chrono::steady_clock::time_point> messages_reaction_times;
+    std::unordered_set<dpp::snowflake> processed_messages;
+    size_t rated_messages{};
+    Histogram latency_histogram;
+    fake_discord_client->SetBotReactionCallback([&](dpp::snowflake const message_id, std::string const& reaction) {
+      if (kProcessedMessageEmoji != reaction) {
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> const mutex_lock_guard(replay_mutex);
+        auto const it_message_reaction_time = messages_reaction_times.find(message_id);
+        if (messages_reaction_times.end() == it_message_reaction_time) {
+          return;
+        }
+
+        latency_histogram.Record(std::chrono::steady_clock::now() - it_message_reaction_time->second);
+        messages_reaction_times.erase(it_message_reaction_time);
+        processed_messages.insert(message_id);
+        ++rated_messages;
+      }
+
+      replay_condition_variable.notify_one();
+    });
+
+    auto const startup_time = std::chrono::steady_clock::now();
+    auto const rest_budgeter = std::make_shared<RestBudgeter>(static_cast<double>(options.global_limit));
+    auto pokatto_prestige = std::make_unique<PokattoPrestige>(fake_discord_client, rest_budgeter);
+    auto const startup_duration = std::chrono::steady_clock::now() - startup_time;
+
+    // Events are replayed once the backfill is done, so they are timed on their own
+    pokatto_prestige->WaitForBackfill();
+    auto const backfill_duration = std::chrono::steady_clock::now() - startup_time - startup_duration;
+
+    size_t reactions{};
+    size_t reaction_removals{};
+    size_t points_histories{};
+    auto const replay_time = std::chrono::steady_clock::now();
+    for (auto const& event : events) {
+      std::this_thread::sleep_until(replay_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(event.offset / options.speed));
+
+      if (ReplayEvent::Type::kPointsHistory == event.type) {
+        pokatto_prestige->SendPointsHistory(event.user_id);
+        ++points_histories;
+        continue;
+      }
+
+      if (ReplayEvent::Type::kReactionRemove == event.type) {
+        if (fake_discord_client->RemoveReaction(event.message_id, kSquchanUserId, event.emoji)) {
+          pokatto_prestige->RemoveRating(event.message_id, event.channel_id, kSquchanUserId, event.emoji);
+          ++reaction_removals;
+        }
+        continue;
+      }
+
+      if (!fake_discord_client->AddReaction(event.message_id, kSquchanUserId, event.emoji)) {
+        continue;
+      }
+
+      {
+        std::lock_guard<std::mutex> const mutex_lock_guard(replay_mutex);
+        if (!processed_messages.contains(event.message_id)) {
+          messages_reaction_times.try_emplace(event.message_id, std::chrono::steady_clock::now());
+        }
+      }
+      pokatto_prestige->AddRating(event.message_id, event.channel_id, kSquchanUserId, event.emoji);
+      ++reactions;
+    }
+
+    size_t pending_messages{};
+    {
+      std::unique_lock<std::mutex> mutex_unique_lock(replay_mutex);
+      replay_condition_variable.wait_for(mutex_unique_lock, std::chrono::seconds(options.timeout_seconds),
+                                         [&messages_reaction_times]{ return messages_reaction_times.empty(); });
+      pending_messages = messages_reaction_times.size();
+    }
+    auto const replay_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - replay_time).count();
+
+    pokatto_prestige.reset();
+    fake_discord_client->SetBotReactionCallback({});
+
+    auto const latency = latency_histogram.GetSummary();
+    fmt::print("Replayed events. Reactions: '{}'. Reaction removals: '{}'. Points histories: '{}'. Speed: '{}x'\n",
+               reactions, reaction_removals, points_histories, options.speed);
+    fmt::print("Startup: '{:.1f}ms'. Backfill: '{:.1f}ms'. Replay: '{:.2f}s'. Ratings per second: '{:.1f}'\n",
+               std::chrono::duration<double, std::milli>(startup_duration).count(),
+               std::chrono::duration<double, std::milli>(backfill_duration).count(), replay_duration,
+               static_cast<double>(rated_messages) / replay_duration);
+    fmt::print("Reaction to processed latency. Count: '{}'. P50: '{:.1f}ms'. P90: '{:.1f}ms'. P99: '{:.1f}ms'. Max: '{:.1f}ms'\n",
+               latency.count, ::GetMilliseconds(latency.p50), ::GetMilliseconds(latency.p90), ::GetMilliseconds(latency.p99),
+               ::GetMilliseconds(latency.max));
+    fmt::print("Fake Discord. Requests: '{}'. Too many requests: '{}'. Direct messages: '{}'. Unprocessed ratings: '{}'\n",
+               fake_discord_client->GetRequests(), fake_discord_client->GetTooManyRequests(), fake_discord_client->GetDirectMessages(),
+               pending_messages);
+
+    return (0 == pending_messages) ? 0 : 1;
+  }
+}
+
+int main(int const argc, char const *const *const argv) {
+  try {
+    Options options;
+    ::ParseArguments(argc, argv, options);
+
+    auto const events_path = options.events_path.empty() ? std::filesystem::path() : std::filesystem::absolute(options.events_path);
+    return ::Replay(options, events_path);
+  }
+  catch (std::exception const& exception) {
+    std::cerr << exception.what();
+    return -1;
+  }
+}
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <latch>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <dpp/dpp.h>
+
+#include "fake_rest_backend.h"
+#include "pokatto_prestige/scheduler/rest_budgeter.h"
+
+namespace {
+  auto constexpr kRouteLimit = 5ULL;
+  auto constexpr kGlobalLimit = 10ULL;
+  auto constexpr kLatency = std::chrono::milliseconds(20);
+  auto constexpr kLeaderboardRequests = 5ULL;
+  auto constexpr kResyncRoute = "messages_get:1";
+  auto constexpr kLeaderboardRoute = "message_edit:2";
+
+  dpp::job RunBudgetedRequest(RestBudgeter& rest_budgeter, FakeRestBackend& fake_rest_backend, std::string const route,
+                              RestBudgeter::Priority const priority, std::latch& completed_requests) {
+    co_await rest_budgeter.Schedule(route, priority, [&fake_rest_backend, &route]{ return fake_rest_backend.Request(route); });
+    completed_requests.count_down();
+  }
+
+  dpp::job RunRequest(FakeRestBackend& fake_rest_backend, std::string const route, std::latch& completed_requests) {
+    co_await fake_rest_backend.Request(route);
+    completed_requests.count_down();
+  }
+
+  double GetMeanWaitMilliseconds(RestBudgeter::Metrics const& metrics) noexcept {
+    if (0 == metrics.throttled) {
+      return 0.0;
+    }
+
+    return std::chrono::duration<double, std::milli>(metrics.total_wait).count() / static_cast<double>(metrics.throttled);
+  }
+}
+
+// A resync burst followed by a handful of leaderboard edits, all behind the budgeter. The edits should overtake the
+// queued burst and no request should be answered with a 429.
+static void BM_RestBudgeterBurst(benchmark::State& state) {
+  auto const burst_requests = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    FakeRestBackend fake_rest_backend(kRouteLimit, kGlobalLimit, kLatency);
+    RestBudgeter rest_budgeter(static_cast<double>(kGlobalLimit));
+
+    std::latch completed_requests(static_cast<std::ptrdiff_t>(burst_requests + kLeaderboardRequests));
+    for (size_t request = 0; request < burst_requests; ++request) {
+      ::RunBudgetedRequest(rest_budgeter, fake_rest_backend, kResyncRoute, RestBudgeter::Priority::kResync, completed_requests);
+    }
+    for (size_t request = 0; request < kLeaderboardRequests; ++request) {
+      ::RunBudgetedRequest(rest_budgeter, fake_rest_backend, kLeaderboardRoute, RestBudgeter::Priority::kLeaderboard, completed_requests);
+    }
+    completed_requests.wait();
+
+    state.counters["too_many_requests"] = static_cast<double>(fake_rest_backend.GetTooManyRequests());
+    state.counters["resync_wait_ms"] = ::GetMeanWaitMilliseconds(rest_budgeter.GetMetrics(RestBudgeter::Priority::kResync));
+    state.counters["leaderboard_wait_ms"] = ::GetMeanWaitMilliseconds(rest_budgeter.GetMetrics(RestBudgeter::Priority::kLeaderboard));
+    state.counters["max_queued"] = static_cast<double>(rest_budgeter.GetMetrics(RestBudgeter::Priority::kResync).max_queued);
+  }
+}
+BENCHMARK(BM_RestBudgeterBurst)->Arg(20)->Arg(40)->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// The same burst sent straight to the backend, the baseline for how many requests the budgeter keeps from being limited
+static void BM_UnbudgetedBurst(benchmark::State& state) {
+  auto const burst_requests = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    FakeRestBackend fake_rest_backend(kRouteLimit, kGlobalLimit, kLatency);
+
+    std::latch completed_requests(static_cast<std::ptrdiff_t>(burst_requests + kLeaderboardRequests));
+    for (size_t request = 0; request < burst_requests; ++request) {
+      ::RunRequest(fake_rest_backend, kResyncRoute, completed_requests);
+    }
+    for (size_t request = 0; request < kLeaderboardRequests; ++request) {
+      ::RunRequest(fake_rest_backend, kLeaderboardRoute, completed_requests);
+    }
+    completed_requests.wait();
+
+    state.counters["too_many_requests"] = static_cast<double>(fake_rest_backend.GetTooManyRequests());
+  }
+}
+BENCHMARK(BM_UnbudgetedBurst)->Arg(20)->Arg(40)->Iterations(1)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,97 @@
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <dpp/dpp.h>
+
+#include "pokatto_prestige/snapshot/prestige_snapshot.h"
+#include "settings/settings.h"
+
+namespace {
+  auto constexpr kFirstUserId = 100000000000000000ULL;
+  auto constexpr kFirstMessageId = 200000000000000000ULL;
+  auto constexpr kBenchmarkDirectory = "pokatto_prestige_benchmark";
+  auto constexpr kSubmissionsPerUser = 4ULL;
+
+  PrestigeSnapshot::State GetState(size_t const users) noexcept {
+    std::mt19937_64 random_engine(users);
+    std::uniform_int_distribution<size_t> rating_distribution(0, 9);
+    std::uniform_int_distribution<uint64_t> mask_distribution(0, (1ULL << static_cast<size_t>(Settings::Rewards::kEnd)) - 1);
+
+    PrestigeSnapshot::State state;
+    state.total_points.reserve(users);
+    state.unlocked_rewards.reserve(users);
+    state.submissions.reserve(users * kSubmissionsPerUser);
+    for (size_t user = 0; user < users; ++user) {
+      size_t points{};
+      for (size_t submission = 0; submission < kSubmissionsPerUser; ++submission) {
+        auto const rating = rating_distribution(random_engine);
+        state.submissions.push_back({kFirstMessageId + (user * kSubmissionsPerUser) + submission, {}, kFirstUserId + user, rating, {}, true});
+        points += rating;
+      }
+
+      state.total_points.emplace_back(kFirstUserId + user, points);
+      state.unlocked_rewards.emplace_back(kFirstUserId + user, mask_distribution(random_engine) & ~1ULL);
+    }
+
+    return state;
+  }
+
+  // Snapshots are stored relative to the working directory, so the benchmarks run from a scratch one
+  class ScratchDirectory final {
+  public:
+    ScratchDirectory() :
+      working_directory_(std::filesystem::current_path()) {
+      auto const benchmark_directory = std::filesystem::temp_directory_path() / kBenchmarkDirectory;
+      std::filesystem::create_directories(benchmark_directory / "state");
+      std::filesystem::current_path(benchmark_directory);
+    }
+
+    ~ScratchDirectory() {
+      std::filesystem::current_path(working_directory_);
+    }
+
+  private:
+    std::filesystem::path const working_directory_;
+  };
+}
+
+static void BM_StoreSnapshot(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  auto const snapshot_state = ::GetState(users);
+  ScratchDirectory const scratch_directory;
+
+  for (auto _ : state) {
+    if (!PrestigeSnapshot::StoreSnapshot(snapshot_state)) {
+      state.SkipWithError("Failed to store snapshot");
+      break;
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * users);
+}
+BENCHMARK(BM_StoreSnapshot)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_ReadSnapshot(benchmark::State& state) {
+  auto const users = static_cast<size_t>(state.range(0));
+  ScratchDirectory const scratch_directory;
+  if (!PrestigeSnapshot::StoreSnapshot(::GetState(users))) {
+    state.SkipWithError("Failed to store snapshot");
+    return;
+  }
+
+  for (auto _ : state) {
+    PrestigeSnapshot::State snapshot_state;
+    if (!PrestigeSnapshot::ReadSnapshot(snapshot_state)) {
+      state.SkipWithError("Failed to read snapshot");
+      break;
+    }
+    benchmark::DoNotOptimize(snapshot_state.submissions.size());
+  }
+
+  state.SetItemsProcessed(state.iterations() * users);
+}
+BENCHMARK(BM_ReadSnapshot)->RangeMultiplier(10)->Range(100, 1000000)->Unit(benchmark::kMillisecond)->UseRealTime();
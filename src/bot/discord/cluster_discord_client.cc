@@ -0,0 +1,47 @@
+#include "cluster_discord_client.h"
+
+#include <utility>
+
+ClusterDiscordClient::ClusterDiscordClient(std::shared_ptr<dpp::cluster> bot) noexcept :
+  bot_(std::move(bot)) {
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::DirectMessageCreate(dpp::snowflake const user_id, dpp::message const& message) {
+  return bot_->co_direct_message_create(user_id, message);
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::MessageCreate(dpp::message const& message) {
+  return bot_->co_message_create(message);
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::MessageEdit(dpp::message const& message) {
+  return bot_->co_message_edit(message);
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::MessageDelete(dpp::snowflake const message_id, dpp::snowflake const channel_id) {
+  return bot_->co_message_delete(message_id, channel_id);
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::MessageGet(dpp::snowflake const message_id, dpp::snowflake const channel_id) {
+  return bot_->co_message_get(message_id, channel_id);
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::MessagesGet(dpp::snowflake const channel_id, dpp::snowflake const around,
+                                                                           dpp::snowflake const before, dpp::snowflake const after,
+                                                                           uint64_t const limit) {
+  return bot_->co_messages_get(channel_id, around, before, after, limit);
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::MessageGetReactions(dpp::message const& message, std::string const& reaction,
+                                                                                   dpp::snowflake const before, dpp::snowflake const after,
+                                                                                   dpp::snowflake const limit) {
+  return bot_->co_message_get_reactions(message, reaction, before, after, limit);
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::MessageAddReaction(dpp::message const& message, std::string const& reaction) {
+  return bot_->co_message_add_reaction(message, reaction);
+}
+
+dpp::async<dpp::confirmation_callback_t> ClusterDiscordClient::UserGetCached(dpp::snowflake const user_id) {
+  return bot_->co_user_get_cached(user_id);
+}
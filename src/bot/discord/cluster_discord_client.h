@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <dpp/dpp.h>
+
+#include "discord_client.h"
+
+// Forwards every call to the cluster's coroutine REST calls
+class ClusterDiscordClient final : public DiscordClient {
+public:
+  ClusterDiscordClient() = delete;
+  ~ClusterDiscordClient() override = default;
+
+  ClusterDiscordClient(std::shared_ptr<dpp::cluster> bot) noexcept;
+
+  dpp::async<dpp::confirmation_callback_t> DirectMessageCreate(dpp::snowflake user_id, dpp::message const& message) override;
+  dpp::async<dpp::confirmation_callback_t> MessageCreate(dpp::message const& message) override;
+  dpp::async<dpp::confirmation_callback_t> MessageEdit(dpp::message const& message) override;
+  dpp::async<dpp::confirmation_callback_t> MessageDelete(dpp::snowflake message_id, dpp::snowflake channel_id) override;
+  dpp::async<dpp::confirmation_callback_t> MessageGet(dpp::snowflake message_id, dpp::snowflake channel_id) override;
+  dpp::async<dpp::confirmation_callback_t> MessagesGet(dpp::snowflake channel_id, dpp::snowflake around, dpp::snowflake before,
+                                                       dpp::snowflake after, uint64_t limit) override;
+  dpp::async<dpp::confirmation_callback_t> MessageGetReactions(dpp::message const& message, std::string const& reaction,
+                                                               dpp::snowflake before, dpp::snowflake after, dpp::snowflake limit) override;
+  dpp::async<dpp::confirmation_callback_t> MessageAddReaction(dpp::message const& message, std::string const& reaction) override;
+  dpp::async<dpp::confirmation_callback_t> UserGetCached(dpp::snowflake user_id) override;
+
+private:
+  std::shared_ptr<dpp::cluster> const bot_;
+};
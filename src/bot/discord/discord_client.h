@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <dpp/dpp.h>
+
+// The Discord REST calls the bot makes, implemented by the cluster and by an in-memory fake
+class DiscordClient {
+public:
+  virtual ~DiscordClient() = default;
+
+  virtual dpp::async<dpp::confirmation_callback_t> DirectMessageCreate(dpp::snowflake user_id, dpp::message const& message) = 0;
+  virtual dpp::async<dpp::confirmation_callback_t> MessageCreate(dpp::message const& message) = 0;
+  virtual dpp::async<dpp::confirmation_callback_t> MessageEdit(dpp::message const& message) = 0;
+  virtual dpp::async<dpp::confirmation_callback_t> MessageDelete(dpp::snowflake message_id, dpp::snowflake channel_id) = 0;
+  virtual dpp::async<dpp::confirmation_callback_t> MessageGet(dpp::snowflake message_id, dpp::snowflake channel_id) = 0;
+  virtual dpp::async<dpp::confirmation_callback_t> MessagesGet(dpp::snowflake channel_id, dpp::snowflake around, dpp::snowflake before,
+                                                               dpp::snowflake after, uint64_t limit) = 0;
+  virtual dpp::async<dpp::confirmation_callback_t> MessageGetReactions(dpp::message const& message, std::string const& reaction,
+                                                                       dpp::snowflake before, dpp::snowflake after, dpp::snowflake limit) = 0;
+  virtual dpp::async<dpp::confirmation_callback_t> MessageAddReaction(dpp::message const& message, std::string const& reaction) = 0;
+  virtual dpp::async<dpp::confirmation_callback_t> UserGetCached(dpp::snowflake user_id) = 0;
+};
@@ -0,0 +1,91 @@
+#include "keyed_executor.h"
+
+#include <utility>
+
+KeyedExecutor::KeyedExecutor(size_t const workers) {
+  workers_.reserve(workers);
+  for (size_t worker = 0; worker < workers; ++worker) {
+    workers_.emplace_back([this](){ Work(); });
+  }
+}
+
+KeyedExecutor::~KeyedExecutor() {
+  Stop();
+}
+
+void KeyedExecutor::Submit(std::string const& key, std::function<void()> job) noexcept {
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(jobs_mutex_);
+    // A key is ready only while it has jobs and none of them is running, a running key is made ready again once its
+    // current job finishes
+    auto const [it_key_jobs, inserted] = keys_jobs_.try_emplace(key);
+    it_key_jobs->second.push(std::move(job));
+    if (inserted) {
+      ready_keys_.push(key);
+    }
+
+    ++keys_pending_jobs_[key];
+    ++pending_jobs_;
+  }
+
+  jobs_condition_variable_.notify_one();
+}
+
+size_t KeyedExecutor::GetPendingJobs() const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(jobs_mutex_);
+  return pending_jobs_;
+}
+
+size_t KeyedExecutor::GetPendingJobs(std::string const& key) const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(jobs_mutex_);
+  auto const it_key_pending_jobs = keys_pending_jobs_.find(key);
+  return (keys_pending_jobs_.cend() == it_key_pending_jobs) ? size_t{} : it_key_pending_jobs->second;
+}
+
+void KeyedExecutor::Stop() noexcept {
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(jobs_mutex_);
+    running_ = false;
+  }
+  jobs_condition_variable_.notify_all();
+
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void KeyedExecutor::Work() noexcept {
+  std::unique_lock<std::mutex> mutex_unique_lock(jobs_mutex_);
+  while (true) {
+    jobs_condition_variable_.wait(mutex_unique_lock, [this]{ return !ready_keys_.empty() || !running_; });
+    if (!running_) {
+      return;
+    }
+
+    auto key = std::move(ready_keys_.front());
+    ready_keys_.pop();
+
+    auto& key_jobs = keys_jobs_.at(key);
+    auto job = std::move(key_jobs.front());
+    key_jobs.pop();
+
+    mutex_unique_lock.unlock();
+    job();
+    mutex_unique_lock.lock();
+
+    --pending_jobs_;
+    if (0 == --keys_pending_jobs_.at(key)) {
+      keys_pending_jobs_.erase(key);
+    }
+
+    auto& finished_key_jobs = keys_jobs_.at(key);
+    if (finished_key_jobs.empty()) {
+      keys_jobs_.erase(key);
+    } else {
+      ready_keys_.push(std::move(key));
+      jobs_condition_variable_.notify_one();
+    }
+  }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Jobs with the same key run one at a time in submission order, jobs with different keys run in parallel
+class KeyedExecutor final {
+public:
+  KeyedExecutor() = delete;
+  ~KeyedExecutor();
+
+  KeyedExecutor(size_t workers);
+
+  void Submit(std::string const& key, std::function<void()> job) noexcept;
+
+  size_t GetPendingJobs() const noexcept;
+  size_t GetPendingJobs(std::string const& key) const noexcept;
+
+  void Stop() noexcept;
+
+private:
+  void Work() noexcept;
+
+private:
+  mutable std::mutex jobs_mutex_;
+  std::condition_variable jobs_condition_variable_;
+  std::unordered_map<std::string, std::queue<std::function<void()>>> keys_jobs_;
+  std::queue<std::string> ready_keys_;
+  std::unordered_map<std::string, size_t> keys_pending_jobs_;
+  size_t pending_jobs_ = {};
+  bool running_ = true;
+
+  std::vector<std::thread> workers_;
+};
@@ -0,0 +1,82 @@
+#include "reaction_filter.h"
+
+#include <array>
+#include <utility>
+
+#include "settings/settings.h"
+
+namespace {
+  struct RatingEmoji final {
+    std::string_view name;
+    size_t rating;
+  };
+
+  auto constexpr kRatingEmojis = std::array<RatingEmoji, 10>{{
+    {"x_", 0}, {"1️⃣", 1}, {"2️⃣", 2}, {"3️⃣", 3}, {"4️⃣", 4}, {"5️⃣", 5}, {"6️⃣", 6}, {"7️⃣", 7}, {"8️⃣", 8}, {"9️⃣", 9}
+  }};
+  auto constexpr kRatingEmojisTableSize = 16ULL;
+  auto constexpr kNoRatingEmoji = static_cast<uint8_t>(kRatingEmojis.size());
+
+  // The rating emojis only differ in their first byte and length, which is all the hash looks at
+  constexpr size_t HashEmoji(std::string_view const emoji_name, uint32_t const multiplier) noexcept {
+    return ((static_cast<uint8_t>(emoji_name.front()) * multiplier) ^ emoji_name.size()) % kRatingEmojisTableSize;
+  }
+
+  constexpr uint32_t FindHashMultiplier() noexcept {
+    for (uint32_t multiplier = 1; multiplier < 1024; ++multiplier) {
+      std::array<bool, kRatingEmojisTableSize> used_slots = {};
+      auto perfect = true;
+      for (auto const& rating_emoji : kRatingEmojis) {
+        auto const slot = ::HashEmoji(rating_emoji.name, multiplier);
+        perfect = perfect && !used_slots[slot];
+        used_slots[slot] = true;
+      }
+
+      if (perfect) {
+        return multiplier;
+      }
+    }
+
+    return 0;
+  }
+
+  auto constexpr kHashMultiplier = ::FindHashMultiplier();
+  static_assert(0 != kHashMultiplier, "No perfect hash for the rating emojis");
+
+  constexpr std::array<uint8_t, kRatingEmojisTableSize> BuildRatingEmojisTable() noexcept {
+    std::array<uint8_t, kRatingEmojisTableSize> rating_emojis_table = {};
+    rating_emojis_table.fill(kNoRatingEmoji);
+    for (size_t rating_emoji = 0; rating_emoji < kRatingEmojis.size(); ++rating_emoji) {
+      rating_emojis_table[::HashEmoji(kRatingEmojis[rating_emoji].name, kHashMultiplier)] = static_cast<uint8_t>(rating_emoji);
+    }
+
+    return rating_emojis_table;
+  }
+
+  auto constexpr kRatingEmojisTable = ::BuildRatingEmojisTable();
+}
+
+bool ReactionFilter::Accept(dpp::snowflake const reacting_user_id, dpp::snowflake const channel_id, std::string_view const emoji_name,
+                            size_t& rating) noexcept {
+  auto const accepted = (Settings::Get().GetSquchanUserId() == reacting_user_id) &&
+                        (Settings::Threads::kNone != Settings::Get().GetThread(channel_id)) &&
+                        GetRating(emoji_name, rating);
+
+  (accepted ? accepted_events_ : dropped_events_).Increment();
+
+  return accepted;
+}
+
+bool ReactionFilter::GetRating(std::string_view const emoji_name, size_t& rating) noexcept {
+  if (emoji_name.empty()) {
+    return false;
+  }
+
+  auto const rating_emoji = kRatingEmojisTable[::HashEmoji(emoji_name, kHashMultiplier)];
+  if ((kNoRatingEmoji == rating_emoji) || (kRatingEmojis[rating_emoji].name != emoji_name)) {
+    return false;
+  }
+
+  rating = kRatingEmojis[rating_emoji].rating;
+  return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include <dpp/dpp.h>
+
+#include "metrics/metrics_registry.h"
+
+// Drops reactions that can't be ratings before anything is queued
+class ReactionFilter final {
+public:
+  ReactionFilter() = default;
+  ~ReactionFilter() = default;
+
+  bool Accept(dpp::snowflake reacting_user_id, dpp::snowflake channel_id, std::string_view emoji_name, size_t& rating) noexcept;
+
+  static bool GetRating(std::string_view emoji_name, size_t& rating) noexcept;
+
+private:
+  Counter& accepted_events_ = MetricsRegistry::Get().GetCounter("pokatto_prestige_reaction_events_total", "Reaction events seen",
+                                                                "result=\"accepted\"");
+  Counter& dropped_events_ = MetricsRegistry::Get().GetCounter("pokatto_prestige_reaction_events_total", "Reaction events seen",
+                                                               "result=\"dropped\"");
+};
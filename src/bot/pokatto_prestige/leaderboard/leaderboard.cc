@@ -0,0 +1,166 @@
+#include "leaderboard.h"
+
+#include <algorithm>
+
+namespace {
+  uint64_t GetPriority(dpp::snowflake const user_id) noexcept {
+    // splitmix64, snowflakes are mostly sequential and need scrambling to keep the treap balanced
+    auto priority = static_cast<uint64_t>(user_id) + 0x9E3779B97F4A7C15ULL;
+    priority = (priority ^ (priority >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    priority = (priority ^ (priority >> 27)) * 0x94D049BB133111EBULL;
+    return priority ^ (priority >> 31);
+  }
+}
+
+size_t Leaderboard::Increment(dpp::snowflake const user_id, size_t const points) noexcept {
+  auto const it_user_node = users_nodes_.find(user_id);
+  if (users_nodes_.cend() == it_user_node) {
+    auto const node = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back({user_id, points, ::GetPriority(user_id)});
+    users_nodes_.emplace(user_id, node);
+    Insert(node);
+
+    return points;
+  }
+
+  auto const node = it_user_node->second;
+  if (0 < points) {
+    Erase(node);
+    nodes_[node].points += points;
+    Insert(node);
+  }
+
+  return nodes_[node].points;
+}
+
+size_t Leaderboard::Decrement(dpp::snowflake const user_id, size_t const points) noexcept {
+  auto const it_user_node = users_nodes_.find(user_id);
+  if (users_nodes_.cend() == it_user_node) {
+    return {};
+  }
+
+  auto const node = it_user_node->second;
+  auto const decremented_points = std::min(points, nodes_[node].points);
+  if (0 < decremented_points) {
+    Erase(node);
+    nodes_[node].points -= decremented_points;
+    Insert(node);
+  }
+
+  return nodes_[node].points;
+}
+
+size_t Leaderboard::GetRank(dpp::snowflake const user_id) const noexcept {
+  auto const it_user_node = users_nodes_.find(user_id);
+  if (users_nodes_.cend() == it_user_node) {
+    return {};
+  }
+
+  auto const& key = nodes_[it_user_node->second];
+  size_t preceding{};
+  auto node = root_;
+  while (kNoNode != node) {
+    if (Precedes(nodes_[node], key)) {
+      preceding += GetSubtreeSize(nodes_[node].left) + 1;
+      node = nodes_[node].right;
+    } else if (Precedes(key, nodes_[node])) {
+      node = nodes_[node].left;
+    } else {
+      preceding += GetSubtreeSize(nodes_[node].left);
+      break;
+    }
+  }
+
+  return preceding + 1;
+}
+
+size_t Leaderboard::GetSize() const noexcept {
+  return nodes_.size();
+}
+
+std::vector<std::pair<dpp::snowflake, size_t>> Leaderboard::GetEntries() const noexcept {
+  std::vector<std::pair<dpp::snowflake, size_t>> entries;
+  entries.reserve(nodes_.size());
+  ForEach(nodes_.size(), [&entries](dpp::snowflake const user_id, size_t const points){ entries.emplace_back(user_id, points); });
+
+  return entries;
+}
+
+void Leaderboard::Clear() noexcept {
+  nodes_.clear();
+  users_nodes_.clear();
+  root_ = kNoNode;
+}
+
+bool Leaderboard::Precedes(Node const& lhs, Node const& rhs) const noexcept {
+  return (lhs.points > rhs.points) || ((lhs.points == rhs.points) && (lhs.user_id < rhs.user_id));
+}
+
+uint32_t Leaderboard::GetSubtreeSize(uint32_t const node) const noexcept {
+  return (kNoNode == node) ? 0 : nodes_[node].size;
+}
+
+void Leaderboard::UpdateSubtreeSize(uint32_t const node) noexcept {
+  nodes_[node].size = GetSubtreeSize(nodes_[node].left) + GetSubtreeSize(nodes_[node].right) + 1;
+}
+
+void Leaderboard::Split(uint32_t const node, Node const& key, uint32_t& left, uint32_t& right) noexcept {
+  if (kNoNode == node) {
+    left = kNoNode;
+    right = kNoNode;
+    return;
+  }
+
+  if (Precedes(nodes_[node], key)) {
+    Split(nodes_[node].right, key, nodes_[node].right, right);
+    left = node;
+  } else {
+    Split(nodes_[node].left, key, left, nodes_[node].left);
+    right = node;
+  }
+
+  UpdateSubtreeSize(node);
+}
+
+uint32_t Leaderboard::Merge(uint32_t const left, uint32_t const right) noexcept {
+  if (kNoNode == left) {
+    return right;
+  }
+
+  if (kNoNode == right) {
+    return left;
+  }
+
+  if (nodes_[left].priority > nodes_[right].priority) {
+    nodes_[left].right = Merge(nodes_[left].right, right);
+    UpdateSubtreeSize(left);
+    return left;
+  }
+
+  nodes_[right].left = Merge(left, nodes_[right].left);
+  UpdateSubtreeSize(right);
+  return right;
+}
+
+void Leaderboard::Insert(uint32_t const node) noexcept {
+  nodes_[node].left = kNoNode;
+  nodes_[node].right = kNoNode;
+  nodes_[node].size = 1;
+
+  uint32_t left{};
+  uint32_t right{};
+  Split(root_, nodes_[node], left, right);
+  root_ = Merge(Merge(left, node), right);
+}
+
+void Leaderboard::Erase(uint32_t const node) noexcept {
+  auto const& key = nodes_[node];
+
+  auto* link = &root_;
+  while (*link != node) {
+    --nodes_[*link].size;
+    link = Precedes(nodes_[*link], key) ? &nodes_[*link].right : &nodes_[*link].left;
+  }
+
+  *link = Merge(nodes_[node].left, nodes_[node].right);
+}
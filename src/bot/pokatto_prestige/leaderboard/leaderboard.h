@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+// Ranks users by points, highest first and by user id on ties, in a treap augmented with subtree sizes
+class Leaderboard final {
+public:
+  Leaderboard() = default;
+  ~Leaderboard() = default;
+
+  size_t Increment(dpp::snowflake user_id, size_t points) noexcept;
+  // Points never go below zero, users brought down to zero stay ranked last
+  size_t Decrement(dpp::snowflake user_id, size_t points) noexcept;
+
+  size_t GetRank(dpp::snowflake user_id) const noexcept;
+  size_t GetSize() const noexcept;
+
+  std::vector<std::pair<dpp::snowflake, size_t>> GetEntries() const noexcept;
+
+  void Clear() noexcept;
+
+  template <typename Function>
+  void ForEach(size_t count, Function&& function) const noexcept {
+    ForEach(0, count, std::forward<Function>(function));
+  }
+
+  template <typename Function>
+  void ForEach(size_t first, size_t count, Function&& function) const noexcept {
+    std::vector<uint32_t> path;
+    auto node = root_;
+    while (kNoNode != node) {
+      auto const left_size = GetSubtreeSize(nodes_[node].left);
+      if (first <= left_size) {
+        path.push_back(node);
+        node = (first == left_size) ? kNoNode : nodes_[node].left;
+      } else {
+        first -= left_size + 1;
+        node = nodes_[node].right;
+      }
+    }
+
+    while ((0 < count) && ((kNoNode != node) || !path.empty())) {
+      while (kNoNode != node) {
+        path.push_back(node);
+        node = nodes_[node].left;
+      }
+
+      node = path.back();
+      path.pop_back();
+
+      function(nodes_[node].user_id, nodes_[node].points);
+      --count;
+
+      node = nodes_[node].right;
+    }
+  }
+
+private:
+  static uint32_t constexpr kNoNode = UINT32_MAX;
+
+  struct Node final {
+    dpp::snowflake user_id = {};
+    size_t points = {};
+    uint64_t priority = {};
+    uint32_t left = kNoNode;
+    uint32_t right = kNoNode;
+    uint32_t size = 1;
+  };
+
+  bool Precedes(Node const& lhs, Node const& rhs) const noexcept;
+  uint32_t GetSubtreeSize(uint32_t node) const noexcept;
+  void UpdateSubtreeSize(uint32_t node) noexcept;
+
+  void Split(uint32_t node, Node const& key, uint32_t& left, uint32_t& right) noexcept;
+  uint32_t Merge(uint32_t left, uint32_t right) noexcept;
+
+  void Insert(uint32_t node) noexcept;
+  void Erase(uint32_t node) noexcept;
+
+private:
+  std::vector<Node> nodes_;
+  std::unordered_map<dpp::snowflake, uint32_t> users_nodes_;
+  uint32_t root_ = kNoNode;
+};
@@ -0,0 +1,93 @@
+#include "leaderboard_messages.h"
+
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+  auto constexpr kStateDirectory = "state";
+  auto constexpr kLeaderboardMessagesFilePath = "state/leaderboard_messages.json";
+  auto constexpr kTemporaryLeaderboardMessagesFilePath = "state/leaderboard_messages.json.tmp";
+  auto constexpr kPagesKey = "pages";
+  auto constexpr kMessageIdKey = "message_id";
+  auto constexpr kContentKey = "content";
+}
+
+LeaderboardMessages::LeaderboardMessages() {
+  if (!std::filesystem::exists(kStateDirectory) && !std::filesystem::create_directory(kStateDirectory)) {
+    throw std::runtime_error("Failed to create state directory");
+  }
+
+  if (!std::filesystem::exists(kLeaderboardMessagesFilePath)) {
+    return;
+  }
+
+  try {
+    std::ifstream leaderboard_messages_file(kLeaderboardMessagesFilePath);
+    auto const leaderboard_messages_json = nlohmann::json::parse(leaderboard_messages_file);
+
+    for (auto const& page_json : leaderboard_messages_json[kPagesKey]) {
+      pages_.push_back({page_json[kMessageIdKey].get<dpp::snowflake>(), page_json[kContentKey].get<std::string>()});
+    }
+  } catch (std::exception const& exception) {
+    // Untracked messages are cleared from the channel on the next update, so a bad file is only a slower update
+    pages_.clear();
+    return;
+  }
+
+  tracked_ = true;
+}
+
+bool LeaderboardMessages::IsTracked() const noexcept {
+  return tracked_;
+}
+
+std::vector<LeaderboardMessages::Page> const& LeaderboardMessages::GetPages() const noexcept {
+  return pages_;
+}
+
+bool LeaderboardMessages::StorePages(std::vector<Page> pages) noexcept {
+  pages_ = std::move(pages);
+  tracked_ = true;
+
+  nlohmann::json leaderboard_messages_json;
+  auto& pages_json = leaderboard_messages_json[kPagesKey];
+  pages_json = nlohmann::json::array();
+  for (auto const& page : pages_) {
+    nlohmann::json page_json;
+    page_json[kMessageIdKey] = static_cast<uint64_t>(page.message_id);
+    page_json[kContentKey] = page.content;
+    pages_json.push_back(page_json);
+  }
+
+  {
+    std::ofstream output_file(kTemporaryLeaderboardMessagesFilePath, std::ios_base::out | std::ios_base::trunc);
+    try {
+      output_file << leaderboard_messages_json;
+    } catch (std::exception const& exception) {
+      return false;
+    }
+
+    if (!output_file.good()) {
+      return false;
+    }
+  }
+
+  std::error_code error_code;
+  std::filesystem::rename(kTemporaryLeaderboardMessagesFilePath, kLeaderboardMessagesFilePath, error_code);
+
+  return !error_code;
+}
+
+bool LeaderboardMessages::Forget() noexcept {
+  pages_.clear();
+  tracked_ = false;
+
+  std::error_code error_code;
+  std::filesystem::remove(kLeaderboardMessagesFilePath, error_code);
+
+  return !error_code;
+}
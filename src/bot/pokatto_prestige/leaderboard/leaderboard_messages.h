@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+class LeaderboardMessages final {
+public:
+  struct Page final {
+    dpp::snowflake message_id = {};
+    std::string content;
+  };
+
+  LeaderboardMessages();
+  ~LeaderboardMessages() = default;
+
+  bool IsTracked() const noexcept;
+  std::vector<Page> const& GetPages() const noexcept;
+
+  bool StorePages(std::vector<Page> pages) noexcept;
+  bool Forget() noexcept;
+
+private:
+  bool tracked_ = false;
+  std::vector<Page> pages_;
+};
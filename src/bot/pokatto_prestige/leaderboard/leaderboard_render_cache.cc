@@ -0,0 +1,187 @@
+#include "leaderboard_render_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include <fmt/format.h>
+
+#include "leaderboard_renderer.h"
+#include "pokatto_prestige/pages/page_builder.h"
+
+void LeaderboardRenderCache::Invalidate(dpp::snowflake const user_id) noexcept {
+  if (rendered_) {
+    invalidated_users_.insert(user_id);
+  }
+}
+
+void LeaderboardRenderCache::Clear() noexcept {
+  rendered_ = false;
+}
+
+std::vector<std::string> const& LeaderboardRenderCache::Render(Leaderboard const& leaderboard, UsernameCache const& usernames_cache,
+                                                               std::string const& title) noexcept {
+  if (!rendered_ || (title_ != title) || (leaderboard.GetSize() < ranked_users_.size())) {
+    title_ = title;
+    RenderAll(leaderboard, usernames_cache);
+    return pages_;
+  }
+
+  // Ranks between the old and the new positions of the invalidated users are the only ones that moved. Users who
+  // weren't ranked before push every rank below them down by one.
+  auto const rank_shift = leaderboard.GetSize() - ranked_users_.size();
+  auto first_rank = std::numeric_limits<size_t>::max();
+  size_t new_end{};
+  size_t old_end{};
+  size_t added_users{};
+  for (auto const user_id : invalidated_users_) {
+    auto const rank = leaderboard.GetRank(user_id);
+    auto const it_user_line = users_lines_.find(user_id);
+    if (0 == rank) {
+      if (users_lines_.cend() != it_user_line) {
+        RenderAll(leaderboard, usernames_cache);
+        return pages_;
+      }
+
+      continue;
+    }
+
+    first_rank = std::min(first_rank, rank - 1);
+    new_end = std::max(new_end, rank);
+    if (users_lines_.cend() == it_user_line) {
+      ++added_users;
+    } else {
+      first_rank = std::min(first_rank, it_user_line->second.rank);
+      old_end = std::max(old_end, it_user_line->second.rank + 1);
+    }
+  }
+
+  // Users added without being invalidated can't be placed, nothing rendered so far can be trusted then
+  if (added_users != rank_shift) {
+    RenderAll(leaderboard, usernames_cache);
+    return pages_;
+  }
+
+  if (std::numeric_limits<size_t>::max() == first_rank) {
+    invalidated_users_.clear();
+    return pages_;
+  }
+
+  // Past both ends the same users have to follow in the same order, so both leave as many ranks behind them
+  new_end = std::max(new_end, old_end + rank_shift);
+  old_end = new_end - rank_shift;
+
+  std::vector<dpp::snowflake> ranked_users;
+  ranked_users.reserve(new_end - first_rank);
+  leaderboard.ForEach(first_rank, new_end - first_rank,
+                      [this, &usernames_cache, &ranked_users](dpp::snowflake const user_id, size_t const points) {
+                        ranked_users.push_back(user_id);
+                        if (invalidated_users_.contains(user_id)) {
+                          RenderLine(user_id, points, usernames_cache);
+                        }
+                      });
+
+  if (0 == rank_shift) {
+    std::copy(ranked_users.cbegin(), ranked_users.cend(), ranked_users_.begin() + first_rank);
+  } else {
+    ranked_users_.erase(ranked_users_.begin() + first_rank, ranked_users_.begin() + old_end);
+    ranked_users_.insert(ranked_users_.begin() + first_rank, ranked_users.cbegin(), ranked_users.cend());
+  }
+
+  auto const last_moved_rank = (0 == rank_shift) ? new_end : ranked_users_.size();
+  for (auto rank = first_rank; rank < last_moved_rank; ++rank) {
+    users_lines_[ranked_users_[rank]].rank = rank;
+  }
+
+  // A changed line starting a page may now fit on the one before, so packing resumes on the last page starting before it
+  auto const first_page = static_cast<size_t>(std::lower_bound(pages_first_ranks_.cbegin(), pages_first_ranks_.cend(), first_rank) - pages_first_ranks_.cbegin());
+  PackPages((0 < first_page) ? (first_page - 1) : 0, new_end, rank_shift);
+
+  invalidated_users_.clear();
+
+  return pages_;
+}
+
+void LeaderboardRenderCache::RenderAll(Leaderboard const& leaderboard, UsernameCache const& usernames_cache) noexcept {
+  users_lines_.clear();
+  ranked_users_.clear();
+  invalidated_users_.clear();
+  pages_.clear();
+  pages_first_ranks_.clear();
+
+  ranked_users_.reserve(leaderboard.GetSize());
+  leaderboard.ForEach(leaderboard.GetSize(), [this, &usernames_cache](dpp::snowflake const user_id, size_t const points) {
+    RenderLine(user_id, points, usernames_cache).rank = ranked_users_.size();
+    ranked_users_.push_back(user_id);
+  });
+
+  PackPages(0, ranked_users_.size(), 0);
+  rendered_ = true;
+}
+
+LeaderboardRenderCache::Line& LeaderboardRenderCache::RenderLine(dpp::snowflake const user_id, size_t const points,
+                                                                 UsernameCache const& usernames_cache) noexcept {
+  auto& line = users_lines_[user_id];
+  line.content.clear();
+
+  // Users without points are ranked last and not shown
+  if (0 == points) {
+    return line;
+  }
+
+  std::string username;
+  if (!usernames_cache.GetUsername(user_id, username)) {
+    username = "?";
+  }
+
+  fmt::format_to(std::back_inserter(line.content), LeaderboardRenderer::kEntryFormat, points, (points == 1) ? "" : "s", user_id, username);
+
+  return line;
+}
+
+void LeaderboardRenderCache::PackPages(size_t const first_page, size_t const stable_rank, size_t const rank_shift) noexcept {
+  std::vector<std::string> old_pages(std::make_move_iterator(pages_.begin() + first_page), std::make_move_iterator(pages_.end()));
+  std::vector<size_t> const old_pages_first_ranks(pages_first_ranks_.cbegin() + first_page, pages_first_ranks_.cend());
+  pages_.resize(first_page);
+  pages_first_ranks_.resize(first_page);
+
+  auto page_first_rank = old_pages_first_ranks.empty() ? 0 : old_pages_first_ranks.front();
+  auto page = (0 == first_page) ? title_ : std::string();
+  for (auto rank = page_first_rank; rank < ranked_users_.size(); ++rank) {
+    auto const& line = users_lines_.find(ranked_users_[rank])->second.content;
+    if (line.empty()) {
+      continue;
+    }
+
+    if (!page.empty() && (PageBuilder::kMaxPageLength < (page.size() + line.size()))) {
+      pages_.push_back(std::move(page));
+      pages_first_ranks_.push_back(page_first_rank);
+      page = std::string();
+      page_first_rank = rank;
+
+      if (stable_rank <= rank) {
+        auto const it_old_page_first_rank = std::lower_bound(old_pages_first_ranks.cbegin(), old_pages_first_ranks.cend(), rank - rank_shift);
+        auto const old_page = static_cast<size_t>(it_old_page_first_rank - old_pages_first_ranks.cbegin());
+        if ((old_pages_first_ranks.cend() != it_old_page_first_rank) && ((rank - rank_shift) == *it_old_page_first_rank) && (0 < first_page + old_page)) {
+          for (auto reused_page = old_page; reused_page < old_pages.size(); ++reused_page) {
+            pages_.push_back(std::move(old_pages[reused_page]));
+            pages_first_ranks_.push_back(old_pages_first_ranks[reused_page] + rank_shift);
+          }
+
+          return;
+        }
+      }
+    }
+
+    page.append(line);
+  }
+
+  if (pages_.empty() && (page == title_)) {
+    page.append(LeaderboardRenderer::kNoEntries);
+  }
+
+  if (!page.empty()) {
+    pages_.push_back(std::move(page));
+    pages_first_ranks_.push_back(page_first_rank);
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+#include "leaderboard.h"
+#include "pokatto_prestige/usernames/username_cache.h"
+
+// Rendered lines and pages of a leaderboard. Only invalidated users' lines are formatted again, and pages are re-packed
+// until one starts on the same line it did before.
+class LeaderboardRenderCache final {
+public:
+  LeaderboardRenderCache() = default;
+  ~LeaderboardRenderCache() = default;
+
+  LeaderboardRenderCache(LeaderboardRenderCache const&) = delete;
+  void operator=(LeaderboardRenderCache const&) = delete;
+
+  void Invalidate(dpp::snowflake user_id) noexcept;
+  // Renders everything again next time, for when the leaderboard was rebuilt rather than incremented
+  void Clear() noexcept;
+
+  // The title heads the first page, a different one renders everything again
+  std::vector<std::string> const& Render(Leaderboard const& leaderboard, UsernameCache const& usernames_cache, std::string const& title) noexcept;
+
+private:
+  struct Line final {
+    std::string content;
+    size_t rank = {};
+  };
+
+  void RenderAll(Leaderboard const& leaderboard, UsernameCache const& usernames_cache) noexcept;
+  Line& RenderLine(dpp::snowflake user_id, size_t points, UsernameCache const& usernames_cache) noexcept;
+  // Pages ending before first_page are kept, old pages are reused once a new one starts on a rank at or past
+  // stable_rank that an old one started on, rank_shift ranks earlier
+  void PackPages(size_t first_page, size_t stable_rank, size_t rank_shift) noexcept;
+
+private:
+  bool rendered_ = false;
+  std::string title_;
+
+  std::unordered_map<dpp::snowflake, Line> users_lines_;
+  std::vector<dpp::snowflake> ranked_users_;
+  std::unordered_set<dpp::snowflake> invalidated_users_;
+
+  std::vector<std::string> pages_;
+  std::vector<size_t> pages_first_ranks_;
+};
@@ -0,0 +1,32 @@
+#include "leaderboard_renderer.h"
+
+#include <string>
+
+namespace {
+  // A few digits of points, a mention and a username
+  auto constexpr kEntryLengthEstimate = 64ULL;
+}
+
+void LeaderboardRenderer::RenderEntries(Leaderboard const& leaderboard, UsernameCache const& usernames_cache, PageBuilder& page_builder) noexcept {
+  auto const section_lines = page_builder.GetSectionLines();
+  page_builder.Reserve(leaderboard.GetSize() * kEntryLengthEstimate);
+
+  // Reused across entries so looking names up doesn't allocate once it has grown to fit them
+  std::string username;
+  leaderboard.ForEach(leaderboard.GetSize(),
+                      [&usernames_cache, &page_builder, &username](dpp::snowflake const user_id, size_t const points) {
+                        if (points == 0) {
+                          return;
+                        }
+
+                        if (!usernames_cache.GetUsername(user_id, username)) {
+                          username = "?";
+                        }
+
+                        page_builder.AppendLine(kEntryFormat, points, (points == 1) ? "" : "s", user_id, username);
+                      });
+
+  if (section_lines == page_builder.GetSectionLines()) {
+    page_builder.AppendLine(kNoEntries);
+  }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string_view>
+
+#include "leaderboard.h"
+#include "pokatto_prestige/pages/page_builder.h"
+#include "pokatto_prestige/usernames/username_cache.h"
+
+// Renders leaderboards as lines of message pages, highest points first
+class LeaderboardRenderer final {
+public:
+  // Points, plural suffix, user id and username of one ranked user
+  static std::string_view constexpr kEntryFormat = "{} point{}: <@{}> - ({})\n";
+  static std::string_view constexpr kNoEntries = "No entries";
+
+  LeaderboardRenderer() = delete;
+  ~LeaderboardRenderer() = delete;
+
+  // Appends to the current section, which is expected to be headed by the leaderboard's title
+  static void RenderEntries(Leaderboard const& leaderboard, UsernameCache const& usernames_cache, PageBuilder& page_builder) noexcept;
+};
@@ -0,0 +1,81 @@
+#include "monthly_points.h"
+
+#include <algorithm>
+
+MonthlyPoints::MonthlyPoints(std::chrono::minutes const utc_offset) noexcept :
+  utc_offset_(utc_offset) {
+}
+
+void MonthlyPoints::Increment(dpp::snowflake const user_id, std::time_t const timestamp, size_t const points) noexcept {
+  auto const month = GetMonth(timestamp);
+  months_users_points_[month][user_id] += points;
+
+  if (month == current_month_) {
+    current_leaderboard_.Increment(user_id, points);
+  }
+}
+
+void MonthlyPoints::Decrement(dpp::snowflake const user_id, std::time_t const timestamp, size_t const points) noexcept {
+  auto const month = GetMonth(timestamp);
+  auto const it_month_users_points = months_users_points_.find(month);
+  if (months_users_points_.cend() == it_month_users_points) {
+    return;
+  }
+
+  auto const it_user_points = it_month_users_points->second.find(user_id);
+  if (it_month_users_points->second.cend() == it_user_points) {
+    return;
+  }
+  it_user_points->second -= std::min(points, it_user_points->second);
+
+  if (month == current_month_) {
+    current_leaderboard_.Decrement(user_id, points);
+  }
+}
+
+bool MonthlyPoints::SetCurrentTime(std::time_t const timestamp) noexcept {
+  auto const month = GetMonth(timestamp);
+  if (month == current_month_) {
+    return false;
+  }
+
+  current_month_ = month;
+  current_leaderboard_.Clear();
+
+  auto const it_month_users_points = months_users_points_.find(month);
+  if (months_users_points_.cend() != it_month_users_points) {
+    for (auto const& [user_id, points] : it_month_users_points->second) {
+      current_leaderboard_.Increment(user_id, points);
+    }
+  }
+
+  return true;
+}
+
+std::chrono::year_month MonthlyPoints::GetMonth(std::time_t const timestamp) const noexcept {
+  auto const local_time = std::chrono::sys_seconds(std::chrono::seconds(timestamp)) + utc_offset_;
+  auto const local_date = std::chrono::year_month_day(std::chrono::floor<std::chrono::days>(local_time));
+
+  return local_date.year() / local_date.month();
+}
+
+std::chrono::year_month MonthlyPoints::GetCurrentMonth() const noexcept {
+  return current_month_;
+}
+
+Leaderboard const& MonthlyPoints::GetCurrentLeaderboard() const noexcept {
+  return current_leaderboard_;
+}
+
+Leaderboard MonthlyPoints::GetLeaderboard(std::chrono::year_month const first_month, std::chrono::year_month const last_month) const noexcept {
+  Leaderboard leaderboard;
+  for (auto it_month_users_points = months_users_points_.lower_bound(first_month);
+       (months_users_points_.cend() != it_month_users_points) && (it_month_users_points->first <= last_month);
+       ++it_month_users_points) {
+    for (auto const& [user_id, points] : it_month_users_points->second) {
+      leaderboard.Increment(user_id, points);
+    }
+  }
+
+  return leaderboard;
+}
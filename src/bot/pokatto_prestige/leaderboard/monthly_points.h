@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <unordered_map>
+
+#include <dpp/dpp.h>
+
+#include "leaderboard.h"
+
+// Points bucketed per month and user, months starting at midnight in a fixed UTC offset. The current month is also ranked.
+class MonthlyPoints final {
+public:
+  MonthlyPoints() = delete;
+  ~MonthlyPoints() = default;
+
+  explicit MonthlyPoints(std::chrono::minutes utc_offset) noexcept;
+
+  void Increment(dpp::snowflake user_id, std::time_t timestamp, size_t points) noexcept;
+  void Decrement(dpp::snowflake user_id, std::time_t timestamp, size_t points) noexcept;
+
+  // Returns whether the current month changed
+  bool SetCurrentTime(std::time_t timestamp) noexcept;
+
+  std::chrono::year_month GetMonth(std::time_t timestamp) const noexcept;
+  std::chrono::year_month GetCurrentMonth() const noexcept;
+  Leaderboard const& GetCurrentLeaderboard() const noexcept;
+
+  // Sums every month from first_month to last_month, both included
+  Leaderboard GetLeaderboard(std::chrono::year_month first_month, std::chrono::year_month last_month) const noexcept;
+
+private:
+  std::chrono::minutes const utc_offset_;
+
+  std::map<std::chrono::year_month, std::unordered_map<dpp::snowflake, size_t>> months_users_points_;
+  std::chrono::year_month current_month_ = {};
+  Leaderboard current_leaderboard_;
+};
@@ -0,0 +1,416 @@
+#include "submission_ledger.h"
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string_view>
+#include <system_error>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "pokatto_prestige/storage/durable_file.h"
+
+namespace {
+  auto constexpr kStateDirectory = "state";
+  auto constexpr kLedgerFilePrefix = std::string_view("ledger.");
+  auto constexpr kLedgerFileSuffix = std::string_view(".jsonl");
+  auto constexpr kRecordTypeKey = "type";
+  auto constexpr kSubmissionRecordType = "submission";
+  auto constexpr kPendingRecordType = "pending";
+  auto constexpr kRatingRecordType = "rating";
+  auto constexpr kCursorRecordType = "cursor";
+  auto constexpr kRewardRecordType = "reward";
+  auto constexpr kMessageIdKey = "message_id";
+  auto constexpr kThreadIdKey = "thread_id";
+  auto constexpr kUserIdKey = "user_id";
+  auto constexpr kRatingKey = "rating";
+  auto constexpr kTimestampKey = "timestamp";
+  auto constexpr kRewardKey = "reward";
+
+  std::string GetLedgerFilePath(uint64_t const generation) noexcept {
+    return fmt::format("{}/{}{}{}", kStateDirectory, kLedgerFilePrefix, generation, kLedgerFileSuffix);
+  }
+
+  std::vector<uint64_t> GetLedgerGenerations() noexcept {
+    std::vector<uint64_t> generations;
+
+    std::error_code error_code;
+    for (auto const& directory_entry : std::filesystem::directory_iterator(kStateDirectory, error_code)) {
+      auto const file_name = directory_entry.path().filename().string();
+      if (!file_name.starts_with(kLedgerFilePrefix) || !file_name.ends_with(kLedgerFileSuffix)) {
+        continue;
+      }
+
+      auto const generation_string = std::string_view(file_name).substr(kLedgerFilePrefix.size(),
+                                                                         file_name.size() - kLedgerFilePrefix.size() - kLedgerFileSuffix.size());
+      uint64_t generation{};
+      auto const [end, error] = std::from_chars(generation_string.data(), generation_string.data() + generation_string.size(), generation);
+      if ((std::errc{} == error) && ((generation_string.data() + generation_string.size()) == end)) {
+        generations.push_back(generation);
+      }
+    }
+
+    std::sort(generations.begin(), generations.end());
+
+    return generations;
+  }
+}
+
+SubmissionLedger::SubmissionLedger() {
+  if (!std::filesystem::exists(kStateDirectory) && !std::filesystem::create_directory(kStateDirectory)) {
+    throw std::runtime_error("Failed to create state directory");
+  }
+
+  auto const generations = ::GetLedgerGenerations();
+  generation_ = generations.empty() ? 0 : generations.back();
+  ledger_file_generation_ = generation_;
+  auto const ledger_file_path = ::GetLedgerFilePath(generation_);
+
+  // A crash mid-append can leave the last record without its line ending, so terminate it before appending after it
+  auto terminate_last_record = false;
+  if (std::filesystem::exists(ledger_file_path) && (0 < std::filesystem::file_size(ledger_file_path))) {
+    std::ifstream ledger_file(ledger_file_path, std::ios_base::in | std::ios_base::binary);
+    ledger_file.seekg(-1, std::ios_base::end);
+    terminate_last_record = ('\n' != ledger_file.get());
+  }
+
+  ledger_file_ = std::fopen(ledger_file_path.c_str(), "ab");
+  if (nullptr == ledger_file_) {
+    throw std::runtime_error("Failed to open submission ledger");
+  }
+
+  if (terminate_last_record && !DurableFile::Write(ledger_file_, std::as_bytes(std::span("\n", 1)))) {
+    throw std::runtime_error("Failed to terminate submission ledger");
+  }
+}
+
+SubmissionLedger::~SubmissionLedger() {
+  Commit();
+  std::fclose(ledger_file_);
+}
+
+void SubmissionLedger::Restore(std::vector<Submission> const& submissions,
+                               std::vector<std::pair<dpp::snowflake, dpp::snowflake>> const& threads_cursors) noexcept {
+  submissions_.clear();
+  users_submissions_.clear();
+  for (auto const& submission : submissions) {
+    ApplySubmission(submission);
+  }
+
+  threads_cursors_ = std::map<dpp::snowflake, dpp::snowflake>(threads_cursors.cbegin(), threads_cursors.cend());
+}
+
+bool SubmissionLedger::ReadLedger(uint64_t const generation, std::vector<Submission>& read_submissions,
+                                  std::vector<RatingChange>& read_ratings_changes, std::vector<RewardUnlock>& read_rewards_unlocks) noexcept {
+  for (auto const ledger_generation : ::GetLedgerGenerations()) {
+    if (ledger_generation < generation) {
+      continue;
+    }
+
+    std::ifstream ledger_file(::GetLedgerFilePath(ledger_generation), std::ios_base::in | std::ios_base::binary);
+    if (!ledger_file.is_open()) {
+      return false;
+    }
+
+    std::string record;
+    while (std::getline(ledger_file, record)) {
+      try {
+        auto const record_json = nlohmann::json::parse(record);
+
+        auto const record_type = record_json[kRecordTypeKey].get<std::string>();
+        if ((kSubmissionRecordType == record_type) || (kPendingRecordType == record_type)) {
+          Submission submission;
+          submission.message_id = record_json[kMessageIdKey].get<dpp::snowflake>();
+          submission.thread_id = record_json[kThreadIdKey].get<dpp::snowflake>();
+          submission.user_id = record_json[kUserIdKey].get<dpp::snowflake>();
+          submission.rating = record_json[kRatingKey].get<size_t>();
+          submission.timestamp = static_cast<std::time_t>(record_json[kTimestampKey].get<int64_t>());
+          submission.rated = (kSubmissionRecordType == record_type);
+
+          if (ApplySubmission(submission) && submission.rated) {
+            read_submissions.push_back(submission);
+          }
+        } else if (kRatingRecordType == record_type) {
+          RatingChange rating_change;
+          if (ApplyRating(record_json[kMessageIdKey].get<dpp::snowflake>(), record_json[kRatingKey].get<size_t>(), rating_change)) {
+            read_ratings_changes.push_back(rating_change);
+          }
+        } else if (kCursorRecordType == record_type) {
+          auto const thread_id = record_json[kThreadIdKey].get<dpp::snowflake>();
+          auto const message_id = record_json[kMessageIdKey].get<dpp::snowflake>();
+          if (GetThreadCursor(thread_id) < message_id) {
+            threads_cursors_[thread_id] = message_id;
+          }
+        } else if (kRewardRecordType == record_type) {
+          read_rewards_unlocks.push_back({record_json[kUserIdKey].get<dpp::snowflake>(), record_json[kRewardKey].get<size_t>()});
+        }
+      } catch (std::exception const& exception) {
+        // Only a record torn by a crash or a failed write can fail to parse, every record around it is intact
+        continue;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool SubmissionLedger::Contains(dpp::snowflake const message_id) const noexcept {
+  auto const it_submission = submissions_.find(message_id);
+  return (submissions_.cend() != it_submission) && it_submission->second.rated;
+}
+
+bool SubmissionLedger::GetSubmission(dpp::snowflake const message_id, Submission& submission) const noexcept {
+  auto const it_submission = submissions_.find(message_id);
+  if (submissions_.cend() == it_submission) {
+    return false;
+  }
+
+  submission = it_submission->second;
+
+  return true;
+}
+
+bool SubmissionLedger::Record(Submission const& submission) noexcept {
+  nlohmann::json record_json;
+  record_json[kRecordTypeKey] = kSubmissionRecordType;
+  record_json[kMessageIdKey] = static_cast<uint64_t>(submission.message_id);
+  record_json[kThreadIdKey] = static_cast<uint64_t>(submission.thread_id);
+  record_json[kUserIdKey] = static_cast<uint64_t>(submission.user_id);
+  record_json[kRatingKey] = submission.rating;
+  record_json[kTimestampKey] = static_cast<int64_t>(submission.timestamp);
+
+  if (!AppendRecord(record_json.dump())) {
+    return false;
+  }
+
+  auto rated_submission = submission;
+  rated_submission.rated = true;
+  ApplySubmission(rated_submission);
+
+  return true;
+}
+
+bool SubmissionLedger::RecordRating(dpp::snowflake const message_id, size_t const rating, RatingChange& rating_change) noexcept {
+  if (!Contains(message_id)) {
+    return false;
+  }
+
+  nlohmann::json record_json;
+  record_json[kRecordTypeKey] = kRatingRecordType;
+  record_json[kMessageIdKey] = static_cast<uint64_t>(message_id);
+  record_json[kRatingKey] = rating;
+
+  if (!AppendRecord(record_json.dump())) {
+    return false;
+  }
+
+  ApplyRating(message_id, rating, rating_change);
+
+  return true;
+}
+
+bool SubmissionLedger::RecordPending(Submission const& submission) noexcept {
+  if (submissions_.contains(submission.message_id)) {
+    return true;
+  }
+
+  nlohmann::json record_json;
+  record_json[kRecordTypeKey] = kPendingRecordType;
+  record_json[kMessageIdKey] = static_cast<uint64_t>(submission.message_id);
+  record_json[kThreadIdKey] = static_cast<uint64_t>(submission.thread_id);
+  record_json[kUserIdKey] = static_cast<uint64_t>(submission.user_id);
+  record_json[kRatingKey] = size_t{};
+  record_json[kTimestampKey] = static_cast<int64_t>(submission.timestamp);
+
+  if (!AppendRecord(record_json.dump())) {
+    return false;
+  }
+
+  auto pending_submission = submission;
+  pending_submission.rating = {};
+  pending_submission.rated = false;
+  ApplySubmission(pending_submission);
+
+  return true;
+}
+
+bool SubmissionLedger::RecordRewardUnlock(RewardUnlock const& reward_unlock) noexcept {
+  nlohmann::json record_json;
+  record_json[kRecordTypeKey] = kRewardRecordType;
+  record_json[kUserIdKey] = static_cast<uint64_t>(reward_unlock.user_id);
+  record_json[kRewardKey] = reward_unlock.reward;
+
+  return AppendRecord(record_json.dump());
+}
+
+std::map<dpp::snowflake, SubmissionLedger::Submission> const& SubmissionLedger::GetSubmissions() const noexcept {
+  return submissions_;
+}
+
+std::vector<SubmissionLedger::Submission> SubmissionLedger::GetUserSubmissions(dpp::snowflake const user_id) const noexcept {
+  std::vector<Submission> user_submissions;
+
+  auto const it_user_submissions = users_submissions_.find(user_id);
+  if (users_submissions_.cend() == it_user_submissions) {
+    return user_submissions;
+  }
+
+  user_submissions.reserve(it_user_submissions->second.size());
+  for (auto const message_id : it_user_submissions->second) {
+    user_submissions.push_back(submissions_.at(message_id));
+  }
+
+  return user_submissions;
+}
+
+std::map<dpp::snowflake, dpp::snowflake> const& SubmissionLedger::GetThreadsCursors() const noexcept {
+  return threads_cursors_;
+}
+
+dpp::snowflake SubmissionLedger::GetThreadCursor(dpp::snowflake const thread_id) const noexcept {
+  auto const it_thread_cursor = threads_cursors_.find(thread_id);
+  return (threads_cursors_.cend() == it_thread_cursor) ? dpp::snowflake{} : it_thread_cursor->second;
+}
+
+bool SubmissionLedger::AdvanceThreadCursor(dpp::snowflake const thread_id, dpp::snowflake const message_id) noexcept {
+  if (GetThreadCursor(thread_id) >= message_id) {
+    return true;
+  }
+
+  nlohmann::json record_json;
+  record_json[kRecordTypeKey] = kCursorRecordType;
+  record_json[kThreadIdKey] = static_cast<uint64_t>(thread_id);
+  record_json[kMessageIdKey] = static_cast<uint64_t>(message_id);
+
+  if (!AppendRecord(record_json.dump())) {
+    return false;
+  }
+
+  threads_cursors_[thread_id] = message_id;
+
+  return true;
+}
+
+bool SubmissionLedger::ApplySubmission(Submission const& submission) noexcept {
+  auto const [it_submission, inserted] = submissions_.emplace(submission.message_id, submission);
+  if (!inserted) {
+    // A pending submission can only become rated, a rated one is never overwritten
+    if (it_submission->second.rated || !submission.rated) {
+      return false;
+    }
+
+    it_submission->second = submission;
+  }
+
+  users_submissions_[submission.user_id].insert(submission.message_id);
+
+  return true;
+}
+
+bool SubmissionLedger::ApplyRating(dpp::snowflake const message_id, size_t const rating, RatingChange& rating_change) noexcept {
+  auto const it_submission = submissions_.find(message_id);
+  if ((submissions_.cend() == it_submission) || !it_submission->second.rated) {
+    return false;
+  }
+
+  auto& submission = it_submission->second;
+  rating_change = {submission.user_id, submission.timestamp, submission.rating, rating};
+  submission.rating = rating;
+
+  return true;
+}
+
+bool SubmissionLedger::AppendRecord(std::string const& record) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(ledger_mutex_);
+  pending_records_.append(record);
+  pending_records_.push_back('\n');
+  ++appended_records_;
+
+  return true;
+}
+
+bool SubmissionLedger::Commit() noexcept {
+  std::unique_lock<std::mutex> mutex_unique_lock(ledger_mutex_);
+  auto const records = appended_records_;
+  auto const generation = generation_;
+  while ((committed_records_ < records) || (ledger_file_generation_ < generation)) {
+    // Whoever finds no commit in flight writes every buffered record, the others wait for the write to cover theirs
+    if (committing_) {
+      commit_condition_variable_.wait(mutex_unique_lock);
+      continue;
+    }
+
+    committing_ = true;
+    std::string committing_records;
+    committing_records.swap(pending_records_);
+    auto const committing_records_count = appended_records_;
+    auto const committing_generation = generation_;
+    auto const rotating = (ledger_file_generation_ < committing_generation);
+    auto ledger_file = ledger_file_;
+    mutex_unique_lock.unlock();
+
+    // Records appended after a rotation must never land in the generation compacted away with the snapshot
+    std::FILE* rotated_ledger_file = nullptr;
+    if (rotating) {
+      rotated_ledger_file = std::fopen(::GetLedgerFilePath(committing_generation).c_str(), "ab");
+      if ((nullptr != rotated_ledger_file) && !DurableFile::SyncDirectory(kStateDirectory)) {
+        std::fclose(rotated_ledger_file);
+        rotated_ledger_file = nullptr;
+      }
+      ledger_file = rotated_ledger_file;
+    }
+
+    auto const written = (nullptr != ledger_file) && DurableFile::Write(ledger_file, std::as_bytes(std::span(committing_records)));
+
+    mutex_unique_lock.lock();
+    committing_ = false;
+    if (nullptr != rotated_ledger_file) {
+      std::fclose(ledger_file_);
+      ledger_file_ = rotated_ledger_file;
+      ledger_file_generation_ = committing_generation;
+    }
+    if (written) {
+      committed_records_ = committing_records_count;
+    } else {
+      // A failed write can leave part of a record behind, so the retry starts on a new line. Only that fragment fails
+      // to parse, the records written twice are skipped on replay like any other duplicate.
+      pending_records_.insert(0, committing_records);
+      pending_records_.insert(0, 1, '\n');
+    }
+    commit_condition_variable_.notify_all();
+
+    if (!written) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+uint64_t SubmissionLedger::GetFirstGeneration() const noexcept {
+  auto const generations = ::GetLedgerGenerations();
+  return generations.empty() ? generation_ : generations.front();
+}
+
+uint64_t SubmissionLedger::Rotate() noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(ledger_mutex_);
+  return ++generation_;
+}
+
+bool SubmissionLedger::Compact(uint64_t const generation) noexcept {
+  auto compacted = true;
+  for (auto const ledger_generation : ::GetLedgerGenerations()) {
+    if (ledger_generation >= generation) {
+      break;
+    }
+
+    std::error_code error_code;
+    compacted = std::filesystem::remove(::GetLedgerFilePath(ledger_generation), error_code) && compacted;
+  }
+
+  return compacted;
+}
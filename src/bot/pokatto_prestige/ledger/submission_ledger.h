@@ -0,0 +1,91 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+// Write-ahead log of point events, rating changes, reward unlocks and crawl cursors. Replaying a record twice changes
+// nothing, so records are only durable once Commit returns and a failed commit can simply be retried.
+class SubmissionLedger final {
+public:
+  struct Submission final {
+    dpp::snowflake message_id = {};
+    dpp::snowflake thread_id = {};
+    dpp::snowflake user_id = {};
+    size_t rating = {};
+    std::time_t timestamp = {};
+    bool rated = {};
+  };
+
+  struct RatingChange final {
+    dpp::snowflake user_id = {};
+    std::time_t timestamp = {};
+    size_t previous_rating = {};
+    size_t rating = {};
+  };
+
+  struct RewardUnlock final {
+    dpp::snowflake user_id = {};
+    size_t reward = {};
+  };
+
+  SubmissionLedger();
+  ~SubmissionLedger();
+
+  void Restore(std::vector<Submission> const& submissions, std::vector<std::pair<dpp::snowflake, dpp::snowflake>> const& threads_cursors) noexcept;
+  bool ReadLedger(uint64_t generation, std::vector<Submission>& read_submissions, std::vector<RatingChange>& read_ratings_changes,
+                  std::vector<RewardUnlock>& read_rewards_unlocks) noexcept;
+
+  bool Contains(dpp::snowflake message_id) const noexcept;
+  bool GetSubmission(dpp::snowflake message_id, Submission& submission) const noexcept;
+  bool Record(Submission const& submission) noexcept;
+  // Only rated submissions can have their rating changed
+  bool RecordRating(dpp::snowflake message_id, size_t rating, RatingChange& rating_change) noexcept;
+  bool RecordPending(Submission const& submission) noexcept;
+  bool RecordRewardUnlock(RewardUnlock const& reward_unlock) noexcept;
+
+  std::map<dpp::snowflake, Submission> const& GetSubmissions() const noexcept;
+  std::vector<Submission> GetUserSubmissions(dpp::snowflake user_id) const noexcept;
+  std::map<dpp::snowflake, dpp::snowflake> const& GetThreadsCursors() const noexcept;
+
+  dpp::snowflake GetThreadCursor(dpp::snowflake thread_id) const noexcept;
+  bool AdvanceThreadCursor(dpp::snowflake thread_id, dpp::snowflake message_id) noexcept;
+
+  // Commit waits on other committers, so it is never called with the state lock held
+  bool Commit() noexcept;
+  // Above zero once generations were compacted into a snapshot
+  uint64_t GetFirstGeneration() const noexcept;
+  // Records appended from here on belong to the returned generation, the next Commit moves to its file
+  uint64_t Rotate() noexcept;
+  bool Compact(uint64_t generation) noexcept;
+
+private:
+  bool ApplySubmission(Submission const& submission) noexcept;
+  bool ApplyRating(dpp::snowflake message_id, size_t rating, RatingChange& rating_change) noexcept;
+  bool AppendRecord(std::string const& record) noexcept;
+
+private:
+  std::map<dpp::snowflake, Submission> submissions_;
+  std::unordered_map<dpp::snowflake, std::set<dpp::snowflake>> users_submissions_;
+  std::map<dpp::snowflake, dpp::snowflake> threads_cursors_;
+
+  std::mutex ledger_mutex_;
+  std::condition_variable commit_condition_variable_;
+  std::FILE* ledger_file_ = nullptr;
+  uint64_t generation_ = {};
+  uint64_t ledger_file_generation_ = {};
+  std::string pending_records_;
+  uint64_t appended_records_ = {};
+  uint64_t committed_records_ = {};
+  bool committing_ = false;
+};
@@ -0,0 +1,35 @@
+#include "page_builder.h"
+
+void PageBuilder::BeginSection() noexcept {
+  if (page_begin_ < buffer_.size()) {
+    pages_ends_.push_back(buffer_.size());
+    page_begin_ = buffer_.size();
+  }
+
+  section_lines_ = {};
+}
+
+void PageBuilder::Reserve(size_t const length) noexcept {
+  buffer_.reserve(buffer_.size() + length);
+}
+
+size_t PageBuilder::GetSectionLines() const noexcept {
+  return section_lines_;
+}
+
+std::vector<std::string_view> PageBuilder::GetPages() const noexcept {
+  std::vector<std::string_view> pages;
+  pages.reserve(pages_ends_.size() + 1);
+
+  size_t page_begin{};
+  for (auto const page_end : pages_ends_) {
+    pages.emplace_back(buffer_.data() + page_begin, page_end - page_begin);
+    page_begin = page_end;
+  }
+
+  if (page_begin < buffer_.size()) {
+    pages.emplace_back(buffer_.data() + page_begin, buffer_.size() - page_begin);
+  }
+
+  return pages;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+// Formats lines into one buffer split into pages of whole lines. Pages are slices, valid until the builder changes.
+class PageBuilder final {
+public:
+  static size_t constexpr kMaxPageLength = 2000;
+
+  PageBuilder() = default;
+  ~PageBuilder() = default;
+
+  PageBuilder(PageBuilder const&) = delete;
+  void operator=(PageBuilder const&) = delete;
+
+  // Lines of a section never share a page with the lines before it
+  void BeginSection() noexcept;
+
+  template <typename... Args>
+  void AppendLine(fmt::format_string<Args...> format, Args&&... args) noexcept {
+    auto const line_begin = buffer_.size();
+    fmt::format_to(std::back_inserter(buffer_), format, std::forward<Args>(args)...);
+
+    // A line longer than a page gets a page of its own
+    if ((kMaxPageLength < (buffer_.size() - page_begin_)) && (page_begin_ < line_begin)) {
+      pages_ends_.push_back(line_begin);
+      page_begin_ = line_begin;
+    }
+
+    ++section_lines_;
+  }
+
+  void Reserve(size_t length) noexcept;
+
+  size_t GetSectionLines() const noexcept;
+  std::vector<std::string_view> GetPages() const noexcept;
+
+private:
+  fmt::memory_buffer buffer_;
+  std::vector<size_t> pages_ends_;
+  size_t page_begin_ = {};
+  size_t section_lines_ = {};
+};
@@ -1,23 +1,44 @@
 #include "pokatto_data.h"
 
+#include <algorithm>
+#include <array>
 #include <exception>
 #include <filesystem>
 #include <fstream>
-#include <ranges>
+#include <future>
+#include <thread>
 #include <utility>
 
-#include <fmt/format.h>
 #include <nlohmann/json.hpp>
 
 namespace {
   auto constexpr kDataDirectory = "data";
   auto constexpr kUnlockedRewardsKey = "unlocked_rewards";
-  auto constexpr kSpecialDiscordRoleKey = "special_discord_role";
-  auto constexpr kChaosCatDoodleKey = "chaos_cat_doodle";
-  auto constexpr kPokattosonaKey = "pokattosona";
-  auto constexpr kVipOnTwitchKey = "vip_on_twitch";
-  auto constexpr kStoreMerchKey = "store_merch";
-  auto constexpr kClayPokattoKey = "clay_pokatto";
+  auto constexpr kRewardsKeys = std::array<std::pair<char const*, Settings::Rewards>, 6>{{
+    {"special_discord_role", Settings::Rewards::kSpecialDiscordRole},
+    {"chaos_cat_doodle", Settings::Rewards::kChaosCatDoodle},
+    {"pokattosona", Settings::Rewards::kPokattosona},
+    {"vip_on_twitch", Settings::Rewards::kVipOnTwitch},
+    {"store_merch", Settings::Rewards::kStoreMerch},
+    {"clay_pokatto", Settings::Rewards::kClayPokatto}
+  }};
+
+  PokattoData ReadPokattoData(std::filesystem::path const& file_path) {
+    auto const user_id = static_cast<dpp::snowflake>(std::stoull(file_path.stem().string()));
+
+    std::ifstream pokatto_data_file(file_path);
+    auto const pokatto_data_json = nlohmann::json::parse(pokatto_data_file);
+    auto const& unlocked_rewards_json = pokatto_data_json[kUnlockedRewardsKey];
+
+    PokattoData pokatto_data(user_id);
+    for (auto const& [reward_key, reward] : kRewardsKeys) {
+      if (unlocked_rewards_json[reward_key].get<bool>()) {
+        pokatto_data.UnlockReward(reward);
+      }
+    }
+
+    return pokatto_data;
+  }
 }
 
 PokattoData::PokattoData(dpp::snowflake const user_id) noexcept :
@@ -25,66 +46,71 @@ PokattoData::PokattoData(dpp::snowflake const user_id) noexcept :
 
 }
 
-std::map<dpp::snowflake, PokattoData> PokattoData::ReadPokattosData() {  
+PokattoData::PokattoData(dpp::snowflake const user_id, uint64_t const unlocked_rewards_mask) noexcept :
+  user_id_(user_id),
+  unlocked_rewards_(unlocked_rewards_mask) {
+  unlocked_rewards_.reset(static_cast<size_t>(Settings::Rewards::kNone));
+}
+
+std::vector<PokattoData> PokattoData::ReadPokattosData() {
   if (!std::filesystem::exists(kDataDirectory) && !std::filesystem::create_directory(kDataDirectory)) {
     throw std::runtime_error("Failed to create data directory");
   }
 
-  std::map<dpp::snowflake, PokattoData> pokattos_data;
+  std::vector<std::filesystem::path> files_paths;
   for (auto const& directory_entry : std::filesystem::directory_iterator(kDataDirectory)) {
-    auto const& file_path = directory_entry.path();
-
-    auto const user_id = static_cast<dpp::snowflake>(std::stoull(file_path.stem().string()));
-
-
-    std::ifstream pokatto_data_file(file_path);
-    auto const pokatto_data_json = nlohmann::json::parse(pokatto_data_file);
-    auto const& unlocked_rewards_json = pokatto_data_json[kUnlockedRewardsKey];
-
-    std::map<Settings::Rewards, bool> unlocked_rewards;
-    unlocked_rewards.emplace(Settings::Rewards::kSpecialDiscordRole, unlocked_rewards_json[kSpecialDiscordRoleKey]);
-    unlocked_rewards.emplace(Settings::Rewards::kChaosCatDoodle, unlocked_rewards_json[kChaosCatDoodleKey]);
-    unlocked_rewards.emplace(Settings::Rewards::kPokattosona, unlocked_rewards_json[kPokattosonaKey]);
-    unlocked_rewards.emplace(Settings::Rewards::kVipOnTwitch, unlocked_rewards_json[kVipOnTwitchKey]);
-    unlocked_rewards.emplace(Settings::Rewards::kStoreMerch, unlocked_rewards_json[kStoreMerchKey]);
-    unlocked_rewards.emplace(Settings::Rewards::kClayPokatto, unlocked_rewards_json[kClayPokattoKey]);
+    files_paths.push_back(directory_entry.path());
+  }
 
-    PokattoData pokatto_data(user_id);
-    pokatto_data.unlocked_rewards_ = std::move(unlocked_rewards);
+  // Parsing dominates, so files are split evenly across threads and a failure in any of them is rethrown here
+  auto const threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, std::max<size_t>(files_paths.size(), 1));
+  auto const files_per_thread = (files_paths.size() + threads - 1) / threads;
+
+  std::vector<std::future<std::vector<PokattoData>>> pokattos_data_futures;
+  for (size_t first_file = 0; first_file < files_paths.size(); first_file += files_per_thread) {
+    auto const last_file = std::min(first_file + files_per_thread, files_paths.size());
+    pokattos_data_futures.push_back(std::async(std::launch::async, [&files_paths, first_file, last_file]{
+      std::vector<PokattoData> pokattos_data;
+      pokattos_data.reserve(last_file - first_file);
+      for (auto file = first_file; file < last_file; ++file) {
+        pokattos_data.push_back(::ReadPokattoData(files_paths[file]));
+      }
+
+      return pokattos_data;
+    }));
+  }
 
-    pokattos_data.emplace(user_id, std::move(pokatto_data));
+  std::vector<PokattoData> pokattos_data;
+  pokattos_data.reserve(files_paths.size());
+  for (auto& pokattos_data_future : pokattos_data_futures) {
+    auto const thread_pokattos_data = pokattos_data_future.get();
+    pokattos_data.insert(pokattos_data.end(), thread_pokattos_data.cbegin(), thread_pokattos_data.cend());
   }
 
   return pokattos_data;
 }
 
-bool PokattoData::UnlockReward(Settings::Rewards reward) noexcept {
-  unlocked_rewards_[reward] = true;
-  return StorePokattoData();
+void PokattoData::UnlockReward(Settings::Rewards reward) noexcept {
+  unlocked_rewards_.set(static_cast<size_t>(reward));
 }
 
-bool PokattoData::IsRewardUnlocked(Settings::Rewards reward) noexcept {
-  return unlocked_rewards_[reward];
+bool PokattoData::IsRewardUnlocked(Settings::Rewards reward) const noexcept {
+  return unlocked_rewards_.test(static_cast<size_t>(reward));
 }
 
-bool PokattoData::StorePokattoData() noexcept {
-  nlohmann::json pokatto_data_json;
-
-  auto& unlocked_rewards_json = pokatto_data_json[kUnlockedRewardsKey];
-  unlocked_rewards_json[kSpecialDiscordRoleKey] = IsRewardUnlocked(Settings::Rewards::kSpecialDiscordRole);
-  unlocked_rewards_json[kChaosCatDoodleKey] = IsRewardUnlocked(Settings::Rewards::kChaosCatDoodle);
-  unlocked_rewards_json[kPokattosonaKey] = IsRewardUnlocked(Settings::Rewards::kPokattosona);
-  unlocked_rewards_json[kVipOnTwitchKey] = IsRewardUnlocked(Settings::Rewards::kVipOnTwitch);
-  unlocked_rewards_json[kStoreMerchKey] = IsRewardUnlocked(Settings::Rewards::kStoreMerch);
-  unlocked_rewards_json[kClayPokattoKey] = IsRewardUnlocked(Settings::Rewards::kClayPokatto);
-
-  auto const file_path = fmt::format("{}/{}.json", kDataDirectory, user_id_);
-  std::ofstream output_file(file_path, std::ios_base::out | std::ios_base::trunc);
-  try {
-    output_file << pokatto_data_json;
-  } catch (std::exception const& exception) {
-    return false;
+PokattoData::RewardsMask PokattoData::GetUnlockableRewards(size_t const points, Settings::RewardsPrices const& rewards_prices) const noexcept {
+  RewardsMask affordable_rewards;
+  for (size_t reward = static_cast<size_t>(Settings::Rewards::kBegin); reward < static_cast<size_t>(Settings::Rewards::kEnd); ++reward) {
+    affordable_rewards.set(reward, rewards_prices[reward] <= points);
   }
 
-  return output_file.good();
+  return affordable_rewards & ~unlocked_rewards_;
+}
+
+dpp::snowflake PokattoData::GetUserId() const noexcept {
+  return user_id_;
+}
+
+uint64_t PokattoData::GetUnlockedRewardsMask() const noexcept {
+  return unlocked_rewards_.to_ullong();
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
 
-#include <map>
+#include <bitset>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include <dpp/dpp.h>
 
@@ -9,20 +11,27 @@
 
 class PokattoData final {
 public:
+  using RewardsMask = std::bitset<static_cast<size_t>(Settings::Rewards::kEnd)>;
+
   PokattoData() = delete;
   ~PokattoData() = default;
 
   PokattoData(dpp::snowflake user_id) noexcept;
+  PokattoData(dpp::snowflake user_id, uint64_t unlocked_rewards_mask) noexcept;
 
-  static std::map<dpp::snowflake, PokattoData> ReadPokattosData();
-  
-  bool UnlockReward(Settings::Rewards reward) noexcept;
-  bool IsRewardUnlocked(Settings::Rewards reward) noexcept;
+  // Reads the per-user files rewards were stored in before the ledger, spread across threads
+  static std::vector<PokattoData> ReadPokattosData();
 
-private:
-  bool StorePokattoData() noexcept;
+  void UnlockReward(Settings::Rewards reward) noexcept;
+  bool IsRewardUnlocked(Settings::Rewards reward) const noexcept;
+  // Rewards still locked that the points are enough for
+  RewardsMask GetUnlockableRewards(size_t points, Settings::RewardsPrices const& rewards_prices) const noexcept;
+
+  dpp::snowflake GetUserId() const noexcept;
+  uint64_t GetUnlockedRewardsMask() const noexcept;
 
 private:
-  dpp::snowflake const user_id_ = {};
-  std::map<Settings::Rewards, bool> unlocked_rewards_;
-};
\ No newline at end of file
+  dpp::snowflake user_id_ = {};
+  // Indexed by reward, so the bits match the unlocked rewards mask stored in snapshots
+  RewardsMask unlocked_rewards_;
+};
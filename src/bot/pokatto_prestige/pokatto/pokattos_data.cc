@@ -0,0 +1,46 @@
+#include "pokattos_data.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+  bool PrecedesUserId(PokattoData const& pokatto_data, dpp::snowflake const user_id) noexcept {
+    return pokatto_data.GetUserId() < user_id;
+  }
+}
+
+void PokattosData::Assign(std::vector<PokattoData> pokattos_data) noexcept {
+  pokattos_data_ = std::move(pokattos_data);
+
+  std::stable_sort(pokattos_data_.begin(), pokattos_data_.end(),
+                   [](PokattoData const& lhs, PokattoData const& rhs){ return lhs.GetUserId() < rhs.GetUserId(); });
+  auto const duplicates = std::unique(pokattos_data_.begin(), pokattos_data_.end(),
+                                      [](PokattoData const& lhs, PokattoData const& rhs){ return lhs.GetUserId() == rhs.GetUserId(); });
+  pokattos_data_.erase(duplicates, pokattos_data_.end());
+}
+
+PokattoData& PokattosData::GetOrAdd(dpp::snowflake const user_id) noexcept {
+  auto const it_pokatto_data = std::lower_bound(pokattos_data_.begin(), pokattos_data_.end(), user_id, ::PrecedesUserId);
+  if ((pokattos_data_.end() != it_pokatto_data) && (it_pokatto_data->GetUserId() == user_id)) {
+    return *it_pokatto_data;
+  }
+
+  return *pokattos_data_.emplace(it_pokatto_data, user_id);
+}
+
+PokattoData const* PokattosData::Find(dpp::snowflake const user_id) const noexcept {
+  auto const it_pokatto_data = std::lower_bound(pokattos_data_.cbegin(), pokattos_data_.cend(), user_id, ::PrecedesUserId);
+  if ((pokattos_data_.cend() == it_pokatto_data) || (it_pokatto_data->GetUserId() != user_id)) {
+    return nullptr;
+  }
+
+  return &*it_pokatto_data;
+}
+
+std::vector<PokattoData> const& PokattosData::GetEntries() const noexcept {
+  return pokattos_data_;
+}
+
+size_t PokattosData::GetSize() const noexcept {
+  return pokattos_data_.size();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+#include <dpp/dpp.h>
+
+#include "pokatto_data.h"
+
+// Pokattos data kept contiguous and sorted by user id
+class PokattosData final {
+public:
+  PokattosData() = default;
+  ~PokattosData() = default;
+
+  void Assign(std::vector<PokattoData> pokattos_data) noexcept;
+
+  PokattoData& GetOrAdd(dpp::snowflake user_id) noexcept;
+  PokattoData const* Find(dpp::snowflake user_id) const noexcept;
+
+  std::vector<PokattoData> const& GetEntries() const noexcept;
+  size_t GetSize() const noexcept;
+
+private:
+  std::vector<PokattoData> pokattos_data_;
+};
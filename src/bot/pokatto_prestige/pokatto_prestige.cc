@@ -1,103 +1,136 @@
 #include "pokatto_prestige.h"
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <ctime>
 #include <exception>
 #include <limits>
+#include <string_view>
 #include <utility>
 
 #include <fmt/format.h>
 
 namespace {
-  auto constexpr kMaxMessageLength = 2000ULL;
   auto constexpr kMaxMessagesPerGetCall = 100ULL;
   auto constexpr kProcessedMessageEmoji = "✅";
+  auto constexpr kSnapshotInterval = std::chrono::minutes(5);
+  auto constexpr kMetricsInterval = std::chrono::minutes(5);
+  auto constexpr kMetricsExportInterval = std::chrono::seconds(15);
+  auto constexpr kProcessingWorkers = 4ULL;
+  auto constexpr kLeaderboardKey = "leaderboard";
+  auto constexpr kResyncKey = "resync";
+  auto constexpr kNotFoundStatus = 404;
+
+  template <typename Result>
+  dpp::job CompleteTask(dpp::task<Result> task, std::promise<Result>* const promise) {
+    promise->set_value(co_await std::move(task));
+  }
+
+  // Blocks the calling thread until the task completes. Must only be called from the processing workers or the
+  // constructor, never from a coroutine or a D++ callback, as those run on the threads that complete the task.
+  template <typename Result>
+  Result WaitForTask(dpp::task<Result>&& task) noexcept {
+    std::promise<Result> promise;
+    auto future = promise.get_future();
+    ::CompleteTask(std::move(task), &promise);
+    return future.get();
+  }
+
+  std::string GetMessageKey(dpp::snowflake const message_id) noexcept {
+    return fmt::format("message:{}", message_id);
+  }
+
+  std::string GetUserKey(dpp::snowflake const user_id) noexcept {
+    return fmt::format("user:{}", user_id);
+  }
 
-  std::string GetRewardString(Settings::Rewards const reward) noexcept {
-    switch (reward) {
-      case Settings::Rewards::kSpecialDiscordRole: { return "Special Discord Role"; }
-      case Settings::Rewards::kChaosCatDoodle: { return "Chaos Cat Doodle"; }
-      case Settings::Rewards::kPokattosona: { return "Pokattosona"; }
-      case Settings::Rewards::kVipOnTwitch: { return "Vip on Twitch"; }
-      case Settings::Rewards::kStoreMerch: { return "Store Merch"; }
-      case Settings::Rewards::kClayPokatto: { return "Clay Pokatto"; }
+  // Discord buckets rate limits per endpoint and top level resource, routes mirror that
+  std::string GetRoute(std::string const& endpoint, dpp::snowflake const resource_id) noexcept {
+    return fmt::format("{}:{}", endpoint, resource_id);
+  }
+
+  std::string GetPriorityString(RestBudgeter::Priority const priority) noexcept {
+    switch (priority) {
+      case RestBudgeter::Priority::kInteractive: { return "Interactive"; }
+      case RestBudgeter::Priority::kRating: { return "Rating"; }
+      case RestBudgeter::Priority::kLeaderboard: { return "Leaderboard"; }
+      case RestBudgeter::Priority::kResync: { return "Resync"; }
       default: { return {}; }
     }
   }
 
-  std::string GetThreadString(dpp::snowflake const thread_id) noexcept {
-    if (Settings::Get().GetThreadId(Settings::Threads::kSubmissionFanarts) == thread_id) {
-      return "Fanarts & Bootifur Creations";
+  std::string GetReadinessString(PokattoPrestige::Readiness const readiness) noexcept {
+    switch (readiness) {
+      case PokattoPrestige::Readiness::kBackfilling: { return "Backfilling"; }
+      case PokattoPrestige::Readiness::kReady: { return "Ready"; }
+      case PokattoPrestige::Readiness::kBackfillFailed: { return "Backfill failed"; }
+      default: { return {}; }
     }
+  }
 
-    if (Settings::Get().GetThreadId(Settings::Threads::kSubmissionMemes) == thread_id) {
-      return "Memes";
-    }
+  auto constexpr kRewardsStrings = std::array<std::string_view, static_cast<size_t>(Settings::Rewards::kEnd) + 1>{
+    "", "Special Discord Role", "Chaos Cat Doodle", "Pokattosona", "Vip on Twitch", "Store Merch", "Clay Pokatto", ""
+  };
 
-    if (Settings::Get().GetThreadId(Settings::Threads::kSubmissionThumbnails) == thread_id) {
-      return "Thumbnails";
-    }
+  auto constexpr kThreadsStrings = std::array<std::string_view, static_cast<size_t>(Settings::Threads::kEnd) + 1>{
+    "", "Fanarts & Bootifur Creations", "Memes", "Thumbnails", "Video Edits", "Youtube Clips", ""
+  };
 
-    if (Settings::Get().GetThreadId(Settings::Threads::kSubmissionVideosEdits) == thread_id) {
-      return "Video Edits";
-    }
-    
-    if (Settings::Get().GetThreadId(Settings::Threads::kSubmissionYoutubeClips) == thread_id) {
-      return "Youtube Clips";
-    }
+  std::string_view GetRewardString(Settings::Rewards const reward) noexcept {
+    return kRewardsStrings[static_cast<size_t>(reward)];
+  }
 
-    return {};
+  std::string_view GetThreadString(dpp::snowflake const thread_id) noexcept {
+    return kThreadsStrings[static_cast<size_t>(Settings::Get().GetThread(thread_id))];
   }
   
-  void AppendMessageContent(std::string& message, std::queue<std::string>& content) noexcept {
-    while (!content.empty() && (message.length() + content.front().length()) <= kMaxMessageLength) {
-      message.append(content.front());
-      content.pop();
-    }
-  }
-
-  std::string GetMonthString(int const month) noexcept {
-    switch (month) {
-      case 0: { return "January"; }
-      case 1: { return "February"; }
-      case 2: { return "March"; }
-      case 3: { return "April"; }
-      case 4: { return "May"; }
-      case 5: { return "June"; }
-      case 6: { return "July"; }
-      case 7: { return "August"; }
-      case 8: { return "September"; }
-      case 9: { return "October"; }
-      case 10: { return "November"; }
-      case 11: { return "December"; }
+  std::string GetMonthString(std::chrono::month const month) noexcept {
+    switch (static_cast<unsigned>(month)) {
+      case 1: { return "January"; }
+      case 2: { return "February"; }
+      case 3: { return "March"; }
+      case 4: { return "April"; }
+      case 5: { return "May"; }
+      case 6: { return "June"; }
+      case 7: { return "July"; }
+      case 8: { return "August"; }
+      case 9: { return "September"; }
+      case 10: { return "October"; }
+      case 11: { return "November"; }
+      case 12: { return "December"; }
       default: { return {}; }
     }
   }
+}
 
-  size_t IncrementLeaderboard(std::list<std::pair<dpp::snowflake, size_t>>& pokattos_points, dpp::snowflake const user_id, size_t const rating) noexcept {
-    size_t points{};
-    auto it_pokatto_points = std::find_if(pokattos_points.begin(), pokattos_points.end(),
-                                          [user_id](std::pair<dpp::snowflake, size_t> const& pokatto_points){ return pokatto_points.first == user_id; });
-    if (it_pokatto_points == pokattos_points.cend()) {
-      pokattos_points.emplace_back(std::make_pair(user_id, rating));
-      points = rating;
-    } else {
-      it_pokatto_points->second += rating;
-      points = it_pokatto_points->second ;
+PokattoPrestige::PokattoPrestige(std::shared_ptr<DiscordClient> discord_client, std::shared_ptr<RestBudgeter> rest_budgeter) :
+  discord_client_(std::move(discord_client)),
+  rest_budgeter_(std::move(rest_budgeter)) {
+
+  uint64_t ledger_generation{};
+  if (!RestoreFromSnapshot(ledger_generation)) {
+    // Compacted generations only live on in the snapshot, the pokattos data and the remaining ones would silently miss them
+    if (auto const first_generation = submissions_ledger_.GetFirstGeneration(); 0 < first_generation) {
+      logger_.Critical("No valid snapshot found for a compacted ledger. First generation: '{}'", first_generation);
+      throw std::runtime_error("Failed to restore pokattos points");
     }
 
-    return points;
-  }
-}
+    logger_.Info("No valid snapshot found, reading pokattos data");
 
-PokattoPrestige::PokattoPrestige(std::shared_ptr<dpp::cluster> bot) :
-  bot_(std::move(bot)), pokattos_data_(PokattoData::ReadPokattosData()) {
+    pokattos_data_.Assign(PokattoData::ReadPokattosData());
+  }
 
-  if (!ResyncAllPoints()) {
-    throw std::runtime_error("Failed to resync pokattos points");
+  if (!RestorePointsFromLedger(ledger_generation)) {
+    throw std::runtime_error("Failed to restore pokattos points");
   }
 
+  processing_executor_ = std::make_unique<KeyedExecutor>(kProcessingWorkers);
+  process_submissions_thread_ = std::thread([this](){ Process(); });
+
+  // Events are processed against the restored points while the crawl runs, the ledger settles messages seen by both
+  BackfillNewPoints();
+
   logger_.Info("Initialised Pokatto Prestige");
 }
 
@@ -105,124 +138,338 @@ PokattoPrestige::~PokattoPrestige() {
   process_submissions_ = false;
   submission_condition_variable_.notify_one();
   process_submissions_thread_.join();
+  processing_executor_->Stop();
+
+  if (snapshot_dirty_) {
+    StoreSnapshot();
+  }
+
+  usernames_cache_.Store();
 
   logger_.Info("Terminated Pokatto Prestige");
 }
 
 void PokattoPrestige::AddRating(dpp::snowflake const message_id, dpp::snowflake const channel_id,
-                                dpp::snowflake const reacting_user_id, std::string const& emoji_name) noexcept {
-  if (!IsSubmissionMessage(channel_id) || !IsValidRating(reacting_user_id, emoji_name)) {
+                                dpp::snowflake const reacting_user_id, std::string_view const emoji_name) noexcept {
+  size_t rating{};
+  if (!reaction_filter_.Accept(reacting_user_id, channel_id, emoji_name, rating)) {
     return;
   }
 
-  auto const& rating = rating_emojis_.at(emoji_name);
-  auto const add_rating_processing_function = std::function<void()>([this, channel_id, message_id, rating]{
+  auto const add_rating_processing_function = std::function<void()>([this, channel_id, message_id, rating,
+                                                                      reaction_time = std::chrono::steady_clock::now()]{
     logger_.Info("Adding rating. Message id: '{}'. Rating: '{}'", message_id, rating);
 
-    auto const process_rating = ProcessRating(message_id, channel_id, rating);
-    if (process_rating && (0 < rating)) {
-      UpdateLeaderboard();
+    auto const process_rating = ::WaitForTask(ProcessRating(message_id, channel_id, rating));
+    rating_histogram_.Record(std::chrono::steady_clock::now() - reaction_time);
+    (process_rating ? processed_ratings_counter_ : failed_ratings_counter_).Increment();
+    if (process_rating) {
+      RequestLeaderboardUpdate();
     }
 
     logger_.Info("Finished adding rating. Message id: '{}'. Rating: '{}'", message_id, rating);
   });
-  QueueSubmission(add_rating_processing_function);
+  QueueSubmission(::GetMessageKey(message_id), add_rating_processing_function);
+}
+
+void PokattoPrestige::RemoveRating(dpp::snowflake const message_id, dpp::snowflake const channel_id,
+                                   dpp::snowflake const reacting_user_id, std::string_view const emoji_name) noexcept {
+  size_t rating{};
+  if (!reaction_filter_.Accept(reacting_user_id, channel_id, emoji_name, rating)) {
+    return;
+  }
+
+  auto const remove_rating_processing_function = std::function<void()>([this, message_id, rating]{
+    logger_.Info("Removing rating. Message id: '{}'. Rating: '{}'", message_id, rating);
+
+    // Swapping ratings can add the new emoji before removing the old one, only the rating the message holds is taken back
+    SubmissionLedger::Submission submission;
+    {
+      std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+      if (!submissions_ledger_.GetSubmission(message_id, submission) || !submission.rated || (rating != submission.rating)) {
+        logger_.Info("Rating removal skipped, not the message's rating. Message id: '{}'. Rating: '{}'", message_id, rating);
+        return;
+      }
+    }
+
+    if (::WaitForTask(ChangeRating(message_id, 0, RestBudgeter::Priority::kRating))) {
+      RequestLeaderboardUpdate();
+    }
+
+    logger_.Info("Finished removing rating. Message id: '{}'. Rating: '{}'", message_id, rating);
+  });
+  QueueSubmission(::GetMessageKey(message_id), remove_rating_processing_function);
+}
+
+void PokattoPrestige::AddSubmission(dpp::message const& message) noexcept {
+  if (!IsSubmissionMessage(message.channel_id)) {
+    return;
+  }
+
+  auto const add_submission_processing_function = std::function<void()>([this, message]{
+    logger_.Info("Adding submission. Message id: '{}'. User id: '{}'", message.id, message.author.id);
+
+    RecordPendingSubmission(message);
+  });
+  QueueSubmission(::GetMessageKey(message.id), add_submission_processing_function);
 }
 
 void PokattoPrestige::SendPointsHistory(dpp::snowflake const user_id) noexcept {
   auto const send_points_history_processing_function = std::function<void()>([this, user_id]{
     logger_.Info("Sending points history. User id: '{}'", user_id);
 
+    std::vector<SubmissionLedger::Submission> user_submissions;
+    {
+      std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+      user_submissions = submissions_ledger_.GetUserSubmissions(user_id);
+    }
+
     for (size_t thread = static_cast<size_t>(Settings::Threads::kBegin); thread < static_cast<size_t>(Settings::Threads::kEnd); ++thread) {
       auto const thread_id = Settings::Get().GetThreadId(static_cast<Settings::Threads>(thread));
-      SendThreadPointsToUser(thread_id, user_id);
+      ::WaitForTask(SendThreadPointsToUser(thread_id, user_id, user_submissions));
     }
 
     logger_.Info("Finished sending points history. User id: '{}'", user_id);
   });
-  QueueSubmission(send_points_history_processing_function);
+  QueueSubmission(::GetUserKey(user_id), send_points_history_processing_function);
+}
+
+void PokattoPrestige::SendLeaderboard(dpp::snowflake const user_id, std::optional<std::chrono::year_month> const month) noexcept {
+  auto const send_leaderboard_processing_function = std::function<void()>([this, user_id, month]{
+    logger_.Info("Sending leaderboard. User id: '{}'", user_id);
+
+    PageBuilder page_builder;
+    {
+      std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+      RenderLeaderboard(month, page_builder);
+    }
+
+    auto const pages = page_builder.GetPages();
+    ::WaitForTask(SendDirectMessages(user_id, std::vector<std::string>(pages.cbegin(), pages.cend()), RestBudgeter::Priority::kInteractive));
+
+    logger_.Info("Finished sending leaderboard. User id: '{}'", user_id);
+  });
+  QueueSubmission(::GetUserKey(user_id), send_leaderboard_processing_function);
+}
+
+void PokattoPrestige::UpdateUsername(dpp::snowflake const user_id, std::string const& username) noexcept {
+  // Rendered lines carry the username, so only a changed one has them rendered again
+  if (usernames_cache_.Update(user_id, username)) {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    total_points_render_cache_.Invalidate(user_id);
+    monthly_points_render_cache_.Invalidate(user_id);
+  }
 }
 
 bool PokattoPrestige::IsSubmissionMessage(dpp::snowflake const channel_id) const noexcept {
-  return (Settings::Get().GetThreadId(Settings::Threads::kSubmissionFanarts) == channel_id) ||
-         (Settings::Get().GetThreadId(Settings::Threads::kSubmissionMemes) == channel_id) ||
-         (Settings::Get().GetThreadId(Settings::Threads::kSubmissionThumbnails) == channel_id) ||
-         (Settings::Get().GetThreadId(Settings::Threads::kSubmissionVideosEdits) == channel_id) ||
-         (Settings::Get().GetThreadId(Settings::Threads::kSubmissionYoutubeClips) == channel_id);
+  return Settings::Threads::kNone != Settings::Get().GetThread(channel_id);
 }
 
-bool PokattoPrestige::IsValidRating(dpp::snowflake const user_id, std::string const& emoji_name) const noexcept {
-  return (Settings::Get().GetSquchanUserId() == user_id) && rating_emojis_.contains(emoji_name);
+bool PokattoPrestige::RestoreFromSnapshot(uint64_t& ledger_generation) noexcept {
+  PrestigeSnapshot::State snapshot;
+  if (!PrestigeSnapshot::ReadSnapshot(snapshot)) {
+    return false;
+  }
+
+  for (auto const& [user_id, points] : snapshot.total_points) {
+    pokattos_total_points_.Increment(user_id, points);
+  }
+
+  // Monthly points aren't stored, every rated submission carries its rating and when it was posted
+  for (auto const& submission : snapshot.submissions) {
+    if (submission.rated) {
+      pokattos_monthly_points_.Increment(submission.user_id, submission.timestamp, submission.rating);
+    }
+  }
+
+  std::vector<PokattoData> pokattos_data;
+  pokattos_data.reserve(snapshot.unlocked_rewards.size());
+  for (auto const& [user_id, unlocked_rewards_mask] : snapshot.unlocked_rewards) {
+    pokattos_data.emplace_back(user_id, unlocked_rewards_mask);
+  }
+  pokattos_data_.Assign(std::move(pokattos_data));
+
+  submissions_ledger_.Restore(snapshot.submissions, snapshot.threads_cursors);
+
+  ledger_generation = snapshot.ledger_generation;
+
+  logger_.Info("Restored snapshot. Pokattos: '{}'. Submissions: '{}'", pokattos_total_points_.GetSize(), snapshot.submissions.size());
+
+  return true;
 }
 
-bool PokattoPrestige::ResyncAllPoints() noexcept {
-  logger_.Info("Resyncing all points");
+bool PokattoPrestige::RestorePointsFromLedger(uint64_t const ledger_generation) noexcept {
+  logger_.Info("Restoring points from ledger. Generation: '{}'", ledger_generation);
 
-  for (size_t thread = static_cast<size_t>(Settings::Threads::kBegin); thread < static_cast<size_t>(Settings::Threads::kEnd); ++thread) {
-    auto const thread_id = Settings::Get().GetThreadId(static_cast<Settings::Threads>(thread));
-    if (!ResyncThreadPoints(thread_id, false)) {
-      return false;
+  HandleMonthChange();
+
+  std::vector<SubmissionLedger::Submission> submissions;
+  std::vector<SubmissionLedger::RatingChange> ratings_changes;
+  std::vector<SubmissionLedger::RewardUnlock> rewards_unlocks;
+  if (!submissions_ledger_.ReadLedger(ledger_generation, submissions, ratings_changes, rewards_unlocks)) {
+    logger_.Error("Failed to read ledger. Generation: '{}'", ledger_generation);
+    return false;
+  }
+
+  for (auto const& submission : submissions) {
+    pokattos_total_points_.Increment(submission.user_id, submission.rating);
+    pokattos_monthly_points_.Increment(submission.user_id, submission.timestamp, submission.rating);
+  }
+
+  // Changes only ever take back what was added before them, so applying them after every submission never clamps
+  for (auto const& rating_change : ratings_changes) {
+    ApplyRatingChange(rating_change);
+  }
+
+  for (auto const& reward_unlock : rewards_unlocks) {
+    if ((static_cast<size_t>(Settings::Rewards::kBegin) <= reward_unlock.reward) && (reward_unlock.reward < static_cast<size_t>(Settings::Rewards::kEnd))) {
+      pokattos_data_.GetOrAdd(reward_unlock.user_id).UnlockReward(static_cast<Settings::Rewards>(reward_unlock.reward));
     }
   }
 
-  if (!UpdateLeaderboard()) {
+  snapshot_dirty_ = snapshot_dirty_ || !submissions.empty() || !ratings_changes.empty() || !rewards_unlocks.empty();
+
+  logger_.Info("Finished restoring points from ledger. Submissions: '{}'. Rating changes: '{}'. Reward unlocks: '{}'",
+               submissions.size(), ratings_changes.size(), rewards_unlocks.size());
+
+  return true;
+}
+
+bool PokattoPrestige::StoreSnapshot() noexcept {
+  // Writers are serialised so an older state can never replace a newer one on disk
+  std::lock_guard<std::mutex> const snapshot_lock_guard(snapshot_mutex_);
+  std::unique_lock<std::mutex> state_unique_lock(state_mutex_);
+
+  PrestigeSnapshot::State snapshot;
+  snapshot.total_points = pokattos_total_points_.GetEntries();
+
+  snapshot.unlocked_rewards.reserve(pokattos_data_.GetSize());
+  for (auto const& pokatto_data : pokattos_data_.GetEntries()) {
+    snapshot.unlocked_rewards.emplace_back(pokatto_data.GetUserId(), pokatto_data.GetUnlockedRewardsMask());
+  }
+
+  auto const& threads_cursors = submissions_ledger_.GetThreadsCursors();
+  snapshot.threads_cursors.assign(threads_cursors.cbegin(), threads_cursors.cend());
+
+  auto const& submissions = submissions_ledger_.GetSubmissions();
+  snapshot.submissions.reserve(submissions.size());
+  for (auto const& [message_id, submission] : submissions) {
+    snapshot.submissions.push_back(submission);
+  }
+
+  // Records appended from here on go to the new generation, which is where replay starts from this snapshot
+  snapshot.ledger_generation = submissions_ledger_.Rotate();
+
+  snapshot_dirty_ = false;
+  last_snapshot_time_ = std::chrono::steady_clock::now();
+  state_unique_lock.unlock();
+
+  // The new generation's file has to exist before the snapshot pointing at it does
+  if (!submissions_ledger_.Commit()) {
+    logger_.Error("Failed to rotate ledger");
+
+    std::lock_guard<std::mutex> const state_lock_guard(state_mutex_);
+    snapshot_dirty_ = true;
+    return false;
+  }
+
+  if (!PrestigeSnapshot::StoreSnapshot(snapshot)) {
+    logger_.Error("Failed to store snapshot");
+
+    std::lock_guard<std::mutex> const state_lock_guard(state_mutex_);
+    snapshot_dirty_ = true;
     return false;
   }
 
-  logger_.Info("Finished resyncing all points");
+  if (!submissions_ledger_.Compact(snapshot.ledger_generation)) {
+    logger_.Error("Failed to compact ledger. Generation: '{}'", snapshot.ledger_generation);
+  }
+
+  logger_.Info("Stored snapshot. Pokattos: '{}'. Submissions: '{}'", snapshot.total_points.size(), snapshot.submissions.size());
 
   return true;
 }
 
+void PokattoPrestige::BackfillNewPoints() noexcept {
+  auto const backfill_new_points_processing_function = std::function<void()>([this]{
+    logger_.Info("Resyncing new points");
+
+    auto const resynced = ::WaitForTask(ResyncThreadsPoints(true, false));
+    SetReadiness(resynced ? Readiness::kReady : Readiness::kBackfillFailed);
+    ::WaitForTask(SendDirectMessage(Settings::Get().GetFolleUserId(), resynced ? "FINISHED BACKFILLING POINTS" : "FAILED TO BACKFILL POINTS",
+                                    RestBudgeter::Priority::kInteractive));
+
+    // Held back until now, so the first publish has everything the crawl found
+    RequestLeaderboardUpdate();
+
+    logger_.Info("Finished resyncing new points");
+  });
+  QueueSubmission(kResyncKey, backfill_new_points_processing_function);
+}
+
+void PokattoPrestige::SetReadiness(Readiness const readiness) noexcept {
+  readiness_ = readiness;
+  readiness_.notify_all();
+
+  if (Readiness::kBackfillFailed == readiness) {
+    logger_.Error("Readiness changed. Readiness: '{}'", ::GetReadinessString(readiness));
+  } else {
+    logger_.Info("Readiness changed. Readiness: '{}'", ::GetReadinessString(readiness));
+  }
+}
+
+PokattoPrestige::Readiness PokattoPrestige::GetReadiness() const noexcept {
+  return readiness_;
+}
+
+void PokattoPrestige::WaitForBackfill() const noexcept {
+  readiness_.wait(Readiness::kBackfilling);
+}
+
 void PokattoPrestige::ResyncMissedPoints() noexcept {
   auto const resync_missed_points_processing_function = std::function<void()>([this]{
     logger_.Info("Resyncing missed points");
 
-    for (size_t thread = static_cast<size_t>(Settings::Threads::kBegin); thread < static_cast<size_t>(Settings::Threads::kEnd); ++thread) {
-      auto const thread_id = Settings::Get().GetThreadId(static_cast<Settings::Threads>(thread));
-      ResyncThreadPoints(thread_id, true);
+    // A full crawl covers whatever a failed backfill missed
+    if (::WaitForTask(ResyncThreadsPoints(false, true)) && (Readiness::kBackfillFailed == readiness_)) {
+      SetReadiness(Readiness::kReady);
     }
 
-    UpdateLeaderboard();
+    RequestLeaderboardUpdate();
 
     logger_.Info("Finished resyncing missed points");
   });
-  QueueSubmission(resync_missed_points_processing_function);
+  QueueSubmission(kResyncKey, resync_missed_points_processing_function);
 }
 
-bool PokattoPrestige::HandleMonthChange() noexcept {
-  auto const current_time = std::time(nullptr);
-  int month{};
-  int year{};
-  if (!GetMonthAndYearFromTimestamp(current_time, month, year)) {
-    return false;
-  }
-
-  if ((month != current_month_) || (year != current_year_)) {
-    logger_.Info("Monthly leaderboard has been reseted");
+void PokattoPrestige::HandleMonthChange() noexcept {
+  if (pokattos_monthly_points_.SetCurrentTime(std::time(nullptr))) {
+    auto const current_month = pokattos_monthly_points_.GetCurrentMonth();
+    logger_.Info("Monthly leaderboard has been rolled over. Month: '{}'. Year: '{}'",
+                 ::GetMonthString(current_month.month()), static_cast<int>(current_month.year()));
 
-    pokattos_monthly_points_.clear();
-    
-    current_month_ = month;
-    current_year_ = year;
+    monthly_points_render_cache_.Clear();
   }
-
-  return true;
 }
 
-bool PokattoPrestige::ClearLeaderboardsMessages() const noexcept {
+dpp::task<bool> PokattoPrestige::ClearLeaderboardsMessages() const noexcept {
   logger_.Info("Clearing leaderboard messages");
 
   dpp::snowflake latest_message_id{};
   dpp::message_map messages;
   do {
-    try {
-      messages = bot_->messages_get_sync(Settings::Get().GetPokattoPrestigePathChannelId(), {}, {}, latest_message_id, kMaxMessagesPerGetCall);
-    } catch (dpp::exception const& rest_exception) {
-      logger_.Error("Failed to get leaderboard messages. Exception: '{}'", rest_exception.what());
-      return false;
+    auto const channel_id = Settings::Get().GetPokattoPrestigePathChannelId();
+    auto const messages_result = co_await rest_budgeter_->Schedule(::GetRoute("messages_get", channel_id), RestBudgeter::Priority::kLeaderboard,
+                                                                   [this, channel_id, latest_message_id]{
+      return discord_client_->MessagesGet(channel_id, {}, {}, latest_message_id, kMaxMessagesPerGetCall);
+    });
+    if (messages_result.is_error()) {
+      logger_.Error("Failed to get leaderboard messages. Error: '{}'", messages_result.get_error().message);
+      co_return false;
     }
+    messages = messages_result.get<dpp::message_map>();
 
+    std::vector<dpp::task<bool>> delete_tasks;
     for (auto const& [message_id, message] : messages) {
       if (message_id > latest_message_id) {
         latest_message_id = message_id;
@@ -232,380 +479,885 @@ bool PokattoPrestige::ClearLeaderboardsMessages() const noexcept {
         continue;
       }
 
-      try {
-        auto const delete_confirmation = bot_->message_delete_sync(message_id, Settings::Get().GetPokattoPrestigePathChannelId());
-        if (!delete_confirmation.success) {
-          logger_.Error("Failed to delete leaderboard message.");
-          return false;
-        }
-      } catch (dpp::exception const& rest_exception) {
-        logger_.Error("Failed to delete leaderboard message. Exception: '{}'", rest_exception.what());
-        return false;
-      }
+      delete_tasks.push_back(DeleteLeaderboardMessage(message_id));
+    }
+
+    auto deleted = true;
+    for (auto& delete_task : delete_tasks) {
+      deleted = (co_await std::move(delete_task)) && deleted;
+    }
+
+    if (!deleted) {
+      co_return false;
     }
   } while (!messages.empty());
 
   logger_.Info("Finished clearing leaderboard messages");
 
-  return true;
+  co_return true;
 }
 
 bool PokattoPrestige::UpdateLeaderboard() noexcept {
-  if (!ClearLeaderboardsMessages()) {
-    return false;
+  auto const start_time = std::chrono::steady_clock::now();
+
+  // Missing usernames render as placeholders, so failing to refresh some doesn't hold the leaderboard back
+  ::WaitForTask(RefreshUsernames());
+  auto const usernames_time = std::chrono::steady_clock::now();
+  usernames_histogram_.Record(usernames_time - start_time);
+
+  std::vector<std::string> leaderboard_pages;
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    RenderLeaderboard(leaderboard_pages);
   }
-  
-  std::string leaderboard_message;
-  leaderboard_message.reserve(kMaxMessageLength);
+  auto const render_time = std::chrono::steady_clock::now();
+  render_histogram_.Record(render_time - usernames_time);
 
-  auto leaderboard_entries = GetSortedLeaderboardEntries(false);
-  leaderboard_message = "**Full Pokatto Prestige Leaderboard:**\n";
-  if (!ProcessLeaderboardEntries(leaderboard_message, leaderboard_entries)) {
-    return false;
+  auto const published = ::WaitForTask(PublishLeaderboardPages(std::move(leaderboard_pages)));
+  publish_histogram_.Record(std::chrono::steady_clock::now() - render_time);
+
+  return published;
+}
+
+dpp::task<bool> PokattoPrestige::RefreshUsernames() noexcept {
+  std::vector<dpp::snowflake> users_ids;
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    users_ids.reserve(pokattos_total_points_.GetSize());
+    pokattos_total_points_.ForEach(pokattos_total_points_.GetSize(), [&users_ids](dpp::snowflake const user_id, size_t const points) {
+      if (0 < points) {
+        users_ids.push_back(user_id);
+      }
+    });
+  }
+
+  // Guild member chunks and message authors keep most names fresh, only the rest are looked up one by one
+  auto const stale_users_ids = usernames_cache_.GetStaleUsers(users_ids);
+
+  std::vector<dpp::task<dpp::confirmation_callback_t>> users_tasks;
+  users_tasks.reserve(stale_users_ids.size());
+  for (auto const user_id : stale_users_ids) {
+    users_tasks.push_back(rest_budgeter_->Schedule(::GetRoute("user_get", user_id), RestBudgeter::Priority::kLeaderboard, [this, user_id]{
+      return discord_client_->UserGetCached(user_id);
+    }));
+  }
+
+  auto refreshed = true;
+  for (size_t user = 0; user < users_tasks.size(); ++user) {
+    auto const user_result = co_await std::move(users_tasks[user]);
+    if (user_result.is_error()) {
+      logger_.Error("Failed to get user. User id: '{}'. Error: '{}'", stale_users_ids[user], user_result.get_error().message);
+      refreshed = false;
+      continue;
+    }
+
+    UpdateUsername(stale_users_ids[user], user_result.get<dpp::user_identified>().username);
+  }
+
+  if (!stale_users_ids.empty()) {
+    logger_.Info("Refreshed usernames. Leaderboard users: '{}'. Looked up users: '{}'", users_ids.size(), stale_users_ids.size());
+  }
+
+  if (!usernames_cache_.Store()) {
+    logger_.Error("Failed to store usernames");
+    refreshed = false;
   }
 
-  leaderboard_entries = GetSortedLeaderboardEntries(true);
-  leaderboard_message = fmt::format("**Monthly Pokatto Prestige Leaderboard - {}:**\n", ::GetMonthString(current_month_));
-  if (!ProcessLeaderboardEntries(leaderboard_message, leaderboard_entries)) {
+  co_return refreshed;
+}
+
+void PokattoPrestige::RenderLeaderboard(std::vector<std::string>& leaderboard_pages) noexcept {
+  // The caches only render again the lines of users invalidated since the last update and the pages they land on
+  auto const& total_points_pages = total_points_render_cache_.Render(pokattos_total_points_, usernames_cache_,
+                                                                     "**Full Pokatto Prestige Leaderboard:**\n");
+  leaderboard_pages.assign(total_points_pages.cbegin(), total_points_pages.cend());
+
+  auto const& monthly_points_pages = monthly_points_render_cache_.Render(pokattos_monthly_points_.GetCurrentLeaderboard(), usernames_cache_,
+                                                                         fmt::format("**Monthly Pokatto Prestige Leaderboard - {}:**\n",
+                                                                                     ::GetMonthString(pokattos_monthly_points_.GetCurrentMonth().month())));
+  leaderboard_pages.insert(leaderboard_pages.cend(), monthly_points_pages.cbegin(), monthly_points_pages.cend());
+}
+
+void PokattoPrestige::RenderLeaderboard(std::optional<std::chrono::year_month> const month, PageBuilder& page_builder) const noexcept {
+  // Past months are summed from their buckets on demand, they aren't ranked ahead of time like the current one
+  page_builder.BeginSection();
+  if (month) {
+    page_builder.AppendLine("**Monthly Pokatto Prestige Leaderboard - {} {}:**\n", ::GetMonthString(month->month()), static_cast<int>(month->year()));
+    LeaderboardRenderer::RenderEntries(pokattos_monthly_points_.GetLeaderboard(*month, *month), usernames_cache_, page_builder);
+  } else {
+    auto const current_month = pokattos_monthly_points_.GetCurrentMonth();
+    page_builder.AppendLine("**Year to Date Pokatto Prestige Leaderboard - {}:**\n", static_cast<int>(current_month.year()));
+    LeaderboardRenderer::RenderEntries(pokattos_monthly_points_.GetLeaderboard(current_month.year() / std::chrono::January, current_month),
+                                       usernames_cache_, page_builder);
+  }
+}
+
+void PokattoPrestige::RequestLeaderboardUpdate() noexcept {
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    leaderboard_dirty_ = true;
+    ++requested_leaderboard_updates_;
+  }
+
+  NotifyProcess();
+}
+
+bool PokattoPrestige::PublishLeaderboardUpdate() noexcept {
+  // Requests made while the pages are rendered or published mark the leaderboard dirty again for the next update
+  size_t requested_leaderboard_updates{};
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    requested_leaderboard_updates = requested_leaderboard_updates_;
+    requested_leaderboard_updates_ = {};
+    leaderboard_dirty_ = false;
+  }
+
+  if (!UpdateLeaderboard()) {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    requested_leaderboard_updates_ += requested_leaderboard_updates;
+    leaderboard_dirty_ = true;
     return false;
   }
 
+  std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+  coalesced_leaderboard_updates_ += requested_leaderboard_updates - 1;
+  ++published_leaderboard_updates_;
+
+  logger_.Info("Published leaderboard update. Published updates: '{}'. Coalesced updates: '{}'",
+               published_leaderboard_updates_, coalesced_leaderboard_updates_);
+
   return true;
 }
 
-bool PokattoPrestige::ResyncThreadPoints(dpp::snowflake const thread_id, bool const skip_processed) noexcept {
-  dpp::snowflake latest_message_id{};
-  dpp::message_map messages;
-  do {
-    try {
-      messages = bot_->messages_get_sync(thread_id, {}, {}, latest_message_id, kMaxMessagesPerGetCall);
-    } catch (dpp::exception const& rest_exception) {
-      logger_.Error("Failed to get submission messages. Thread id: '{}'. Exception: '{}'", thread_id, rest_exception.what());
-      return false;
+dpp::task<bool> PokattoPrestige::ResyncThreadsPoints(bool const from_cursors, bool const skip_processed) noexcept {
+  auto const start_time = std::chrono::steady_clock::now();
+  auto const throttled_requests = rest_budgeter_->GetMetrics(RestBudgeter::Priority::kResync).throttled;
+  auto const reaction_fetches = reaction_fetches_.load();
+  auto const avoided_reaction_fetches = avoided_reaction_fetches_.load();
+  auto const retried_requests = rest_budgeter_->GetRetriedRequests();
+
+  // Threads are crawled concurrently, the route scheduler keeps them within the rate limits they share
+  std::atomic<size_t> crawled_messages{};
+  std::vector<dpp::task<bool>> threads_tasks;
+  for (size_t thread = static_cast<size_t>(Settings::Threads::kBegin); thread < static_cast<size_t>(Settings::Threads::kEnd); ++thread) {
+    auto const thread_id = Settings::Get().GetThreadId(static_cast<Settings::Threads>(thread));
+
+    dpp::snowflake thread_cursor{};
+    if (from_cursors) {
+      std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+      thread_cursor = submissions_ledger_.GetThreadCursor(thread_id);
+    }
+    logger_.Info("Resyncing thread points. Thread id: '{}'. Cursor: '{}'", thread_id, thread_cursor);
+
+    threads_tasks.push_back(ResyncThreadPoints(thread_id, thread_cursor, skip_processed, crawled_messages));
+  }
+
+  auto resynced = true;
+  for (auto& thread_task : threads_tasks) {
+    resynced = (co_await std::move(thread_task)) && resynced;
+  }
+
+  auto const elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  logger_.Info("Crawled submission threads. Messages: '{}'. Seconds: '{:.2f}'. Messages per second: '{:.1f}'. Throttled requests: '{}'. Retried requests: '{}'. "
+               "Reaction fetches: '{}'. Avoided reaction fetches: '{}'",
+               crawled_messages.load(), elapsed_seconds, (0 < elapsed_seconds) ? (crawled_messages.load() / elapsed_seconds) : 0.0,
+               rest_budgeter_->GetMetrics(RestBudgeter::Priority::kResync).throttled - throttled_requests, rest_budgeter_->GetRetriedRequests() - retried_requests,
+               reaction_fetches_.load() - reaction_fetches, avoided_reaction_fetches_.load() - avoided_reaction_fetches);
+
+  co_return resynced;
+}
+
+dpp::task<bool> PokattoPrestige::ResyncThreadPoints(dpp::snowflake const thread_id, dpp::snowflake const after_message_id, bool const skip_processed,
+                                                    std::atomic<size_t>& crawled_messages) noexcept {
+  // The next page only needs the newest id of the current one, so it is fetched while the current page is processed
+  auto latest_message_id = after_message_id;
+  auto messages_task = GetThreadMessages(thread_id, latest_message_id);
+  while (true) {
+    auto const messages_result = co_await std::move(messages_task);
+    if (messages_result.is_error()) {
+      logger_.Error("Failed to get submission messages. Thread id: '{}'. Error: '{}'", thread_id, messages_result.get_error().message);
+      co_return false;
+    }
+
+    auto const messages = messages_result.get<dpp::message_map>();
+    if (messages.empty()) {
+      break;
     }
 
     for (auto const& [message_id, message] : messages) {
-      if (message_id > latest_message_id) {
-        latest_message_id = message_id;
-      }
+      latest_message_id = std::max(latest_message_id, message_id);
+    }
+    messages_task = GetThreadMessages(thread_id, latest_message_id);
+    crawled_messages += messages.size();
 
-      auto const it_rating_reaction = std::find_if(message.reactions.cbegin(), message.reactions.cend(),
-                                                   [this](auto const& reaction){ return rating_emojis_.contains(reaction.emoji_name); });
-      if (message.reactions.cend() == it_rating_reaction) {
-        continue;
-      }
+    std::vector<dpp::task<bool>> messages_tasks;
+    messages_tasks.reserve(messages.size());
+    for (auto const& [message_id, message] : messages) {
+      messages_tasks.push_back(ResyncMessagePoints(message, skip_processed));
+    }
 
-      dpp::user_map rating_reaction_users;
-      if (!GetReactionUsers(message, it_rating_reaction->emoji_name, it_rating_reaction->emoji_id, rating_reaction_users)) {
-        return false;
-      }
-      auto const has_squchan_reacted = std::any_of(rating_reaction_users.cbegin(), rating_reaction_users.cend(),
-                                                   [](auto const& user){ return Settings::Get().GetSquchanUserId() == user.first; });
-      if (!has_squchan_reacted) {
-        continue;
-      }
+    auto resynced = true;
+    for (auto& message_task : messages_tasks) {
+      resynced = (co_await std::move(message_task)) && resynced;
+    }
 
-      auto const rating = rating_emojis_.at(it_rating_reaction->emoji_name);
-      if (!ProcessRating(message, rating, skip_processed)) {
-        return false;
-      }
+    // The cursor only moves past a page once all of it is processed, the prefetched page is drained before bailing out
+    std::unique_lock<std::mutex> mutex_unique_lock(state_mutex_);
+    if (resynced && !submissions_ledger_.AdvanceThreadCursor(thread_id, latest_message_id)) {
+      logger_.Error("Failed to advance thread cursor. Thread id: '{}'. Message id: '{}'", thread_id, latest_message_id);
+      resynced = false;
     }
-  } while (!messages.empty());
-  
-  return true;
+    mutex_unique_lock.unlock();
+
+    if (!resynced) {
+      co_await std::move(messages_task);
+      co_return false;
+    }
+  }
+
+  co_return true;
 }
 
-bool PokattoPrestige::ProcessRating(dpp::snowflake const message_id, dpp::snowflake const channel_id, size_t const rating) noexcept {  
-  dpp::message message;
-  try {
-    message = bot_->message_get_sync(message_id, channel_id);
-  } catch (dpp::exception const& rest_exception) {
-    logger_.Error("Failed to get submission message. Message id: '{}'. Channel id: '{}'. Exception: '{}'", message_id, channel_id, rest_exception.what());
-    return false;
+dpp::task<dpp::confirmation_callback_t> PokattoPrestige::GetThreadMessages(dpp::snowflake const thread_id, dpp::snowflake const after_message_id) noexcept {
+  co_return co_await rest_budgeter_->Schedule(::GetRoute("messages_get", thread_id), RestBudgeter::Priority::kResync, [this, thread_id, after_message_id]{
+    return discord_client_->MessagesGet(thread_id, {}, {}, after_message_id, kMaxMessagesPerGetCall);
+  });
+}
+
+dpp::task<bool> PokattoPrestige::ResyncMessagePoints(dpp::message const& message, bool const skip_processed) noexcept {
+  size_t rating{};
+  auto const it_rating_reaction = std::find_if(message.reactions.cbegin(), message.reactions.cend(),
+                                               [&rating](auto const& reaction){ return ReactionFilter::GetRating(reaction.emoji_name, rating); });
+  if (message.reactions.cend() == it_rating_reaction) {
+    co_return RecordPendingSubmission(message);
+  }
+
+  // The bot only marks messages SquChan rated, so a processed message doesn't need its rating reaction users checked
+  bool processed{};
+  if (ResolveProcessed(message, processed) && processed) {
+    ++avoided_reaction_fetches_;
+  } else {
+    ++reaction_fetches_;
+
+    dpp::user_map rating_reaction_users;
+    if (!co_await GetReactionUsers(message, it_rating_reaction->emoji_name, it_rating_reaction->emoji_id, RestBudgeter::Priority::kResync, rating_reaction_users)) {
+      co_return false;
+    }
+    auto const has_squchan_reacted = std::any_of(rating_reaction_users.cbegin(), rating_reaction_users.cend(),
+                                                 [](auto const& user){ return Settings::Get().GetSquchanUserId() == user.first; });
+    if (!has_squchan_reacted) {
+      co_return RecordPendingSubmission(message);
+    }
   }
 
-  return ProcessRating(message, rating, true);
+  co_return co_await ProcessRating(message, rating, skip_processed, RestBudgeter::Priority::kResync);
 }
 
-bool PokattoPrestige::ProcessRating(dpp::message const& message, size_t const rating, bool const skip_processed) noexcept {
+dpp::task<bool> PokattoPrestige::ProcessRating(dpp::snowflake const message_id, dpp::snowflake const channel_id, size_t const rating) noexcept {
+  // The ledger holds everything a rated message's rating change needs, so those don't fetch the message
+  bool rated{};
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    rated = submissions_ledger_.Contains(message_id);
+  }
+  if (rated) {
+    co_return co_await ChangeRating(message_id, rating, RestBudgeter::Priority::kRating);
+  }
+
+  auto const message_result = co_await rest_budgeter_->Schedule(::GetRoute("message_get", channel_id), RestBudgeter::Priority::kRating, [this, message_id, channel_id]{
+    return discord_client_->MessageGet(message_id, channel_id);
+  });
+  if (message_result.is_error()) {
+    logger_.Error("Failed to get submission message. Message id: '{}'. Channel id: '{}'. Error: '{}'", message_id, channel_id, message_result.get_error().message);
+    co_return false;
+  }
+
+  co_return co_await ProcessRating(message_result.get<dpp::message>(), rating, true, RestBudgeter::Priority::kRating);
+}
+
+dpp::task<bool> PokattoPrestige::ProcessRating(dpp::message const message, size_t const rating, bool const skip_processed,
+                                               RestBudgeter::Priority const priority) noexcept {
   auto const& user_id = message.author.id;
-  auto const& username = message.author.username;
+  UpdateUsername(user_id, message.author.username);
 
   logger_.Info("Processing rating. Message id: '{}'. Rating: '{}'. User id: '{}'", message.id, rating, user_id);
 
-  if (!HandleMonthChange()) {
-    return false;
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    HandleMonthChange();
+
+    if (submissions_ledger_.Contains(message.id)) {
+      logger_.Info("Rating skipped, already in ledger. Message id: '{}'. Rating: '{}'. User id: '{}'", message.id, rating, user_id);
+      co_return true;
+    }
   }
 
-  dpp::user_map processed_reaction_users;
-  if (!GetReactionUsers(message, kProcessedMessageEmoji, {}, processed_reaction_users)) {
-    return false;
+  bool processed{};
+  if (ResolveProcessed(message, processed)) {
+    ++avoided_reaction_fetches_;
+  } else {
+    ++reaction_fetches_;
+
+    dpp::user_map processed_reaction_users;
+    if (!co_await GetReactionUsers(message, kProcessedMessageEmoji, {}, priority, processed_reaction_users)) {
+      co_return false;
+    }
+
+    processed = std::any_of(processed_reaction_users.cbegin(), processed_reaction_users.cend(),
+                            [](auto const& user) { return Settings::Get().GetBotUserId() == user.first; });
+    if (processed) {
+      std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+      processed_messages_.insert(message.id);
+    }
   }
 
-  auto const processed = std::any_of(processed_reaction_users.cbegin(), processed_reaction_users.cend(),
-                                      [this](auto const& user) { return Settings::Get().GetBotUserId() == user.first; });
   if (processed && skip_processed) {
     logger_.Info("Rating skipped. Message id: '{}'. Rating: '{}'. User id: '{}'. Processed: '{}'. Skip Processed: '{}'",
                   message.id, rating, user_id, processed, skip_processed);
-    return true;
+    co_return true;
   }
 
-  auto const total_points = ::IncrementLeaderboard(pokattos_total_points_, user_id, rating);
+  // Nothing below awaits until the rewards are claimed, so the lock is held by this thread for the whole section. A
+  // crawl may have recorded the same message while the reactions were fetched, hence the second ledger check.
+  std::unique_lock<std::mutex> mutex_unique_lock(state_mutex_);
+  if (submissions_ledger_.Contains(message.id)) {
+    logger_.Info("Rating skipped, already in ledger. Message id: '{}'. Rating: '{}'. User id: '{}'", message.id, rating, user_id);
+    co_return true;
+  }
+
+  auto const total_points = pokattos_total_points_.Increment(user_id, rating);
 
-  int month{};
-  int year{};
   auto const timestamp = static_cast<std::time_t>(message.get_creation_time());
-  if (!GetMonthAndYearFromTimestamp(timestamp, month, year)) {
-    return false;
-  }
+  pokattos_monthly_points_.Increment(user_id, timestamp, rating);
 
-  if ((month == current_month_) && (year == current_year_)) {
-    logger_.Info("Rating is from current month. Message id: '{}'. Rating: '{}'. User id: '{}'. Month: '{}'. Year: '{}'",
-                  message.id, rating, user_id, month, year);
+  total_points_render_cache_.Invalidate(user_id);
+  monthly_points_render_cache_.Invalidate(user_id);
 
-    ::IncrementLeaderboard(pokattos_monthly_points_, user_id, rating);
+  if (!submissions_ledger_.Record({message.id, message.channel_id, user_id, rating, timestamp})) {
+    logger_.Error("Failed to record submission in ledger. Message id: '{}'. Rating: '{}'. User id: '{}'", message.id, rating, user_id);
+    co_return false;
   }
+  snapshot_dirty_ = true;
 
-  if (!pokattos_data_.contains(user_id)) {
+  if (nullptr == pokattos_data_.Find(user_id)) {
     logger_.Info("User's first entry. Message id: '{}'. Rating: '{}'. User id: '{}'.", message.id, rating, user_id);
+  }
+
+  auto unlocked_rewards = ClaimRewards(message.id, user_id, total_points);
+  mutex_unique_lock.unlock();
 
-    pokattos_data_.emplace(user_id, PokattoData(user_id));
+  // The rating must be durable before it is announced, concurrent ratings share the same fsync
+  if (!submissions_ledger_.Commit()) {
+    logger_.Error("Failed to commit ledger. Message id: '{}'. Rating: '{}'. User id: '{}'", message.id, rating, user_id);
+
+    mutex_unique_lock.lock();
+    ReleaseRewards(user_id, unlocked_rewards);
+    co_return false;
+  }
+
+  // The reward DMs and the processed reaction don't depend on each other so they are all in flight at once
+  auto processed_reaction = rest_budgeter_->Schedule(::GetRoute("reaction_add", message.channel_id), priority, [this, &message]{
+    return discord_client_->MessageAddReaction(message, kProcessedMessageEmoji);
+  });
+  auto const announced_rewards = co_await AnnounceRewards(user_id, std::move(unlocked_rewards), priority);
+
+  auto const processed_reaction_result = co_await std::move(processed_reaction);
+  if (processed_reaction_result.is_error()) {
+    logger_.Error("Failed to add processed reaction. Message id: '{}'. User id: '{}'. Error: '{}'", message.id, user_id, processed_reaction_result.get_error().message);
+    co_return false;
+  }
+
+  if (!announced_rewards) {
+    co_return false;
   }
 
-  for (size_t reward = static_cast<size_t>(Settings::Rewards::kBegin); reward < static_cast<size_t>(Settings::Rewards::kEnd); ++reward) {
+  logger_.Info("Finished processing rating. Message id: '{}'. Rating: '{}'", message.id, rating);
+
+  co_return true;
+}
+
+dpp::task<bool> PokattoPrestige::ChangeRating(dpp::snowflake const message_id, size_t const rating, RestBudgeter::Priority const priority) noexcept {
+  std::unique_lock<std::mutex> mutex_unique_lock(state_mutex_);
+  HandleMonthChange();
+
+  SubmissionLedger::Submission submission;
+  if (submissions_ledger_.GetSubmission(message_id, submission) && (rating == submission.rating)) {
+    logger_.Info("Rating unchanged. Message id: '{}'. Rating: '{}'", message_id, rating);
+    co_return true;
+  }
+
+  SubmissionLedger::RatingChange rating_change;
+  if (!submissions_ledger_.RecordRating(message_id, rating, rating_change)) {
+    logger_.Error("Failed to record rating change in ledger. Message id: '{}'. Rating: '{}'", message_id, rating);
+    co_return false;
+  }
+  snapshot_dirty_ = true;
+
+  auto const& user_id = rating_change.user_id;
+  logger_.Info("Changing rating. Message id: '{}'. Previous rating: '{}'. Rating: '{}'. User id: '{}'",
+               message_id, rating_change.previous_rating, rating, user_id);
+
+  auto const total_points = ApplyRatingChange(rating_change);
+
+  // Rewards stay unlocked when a rating goes down, they were already announced
+  std::vector<Settings::Rewards> unlocked_rewards;
+  if (rating_change.previous_rating < rating) {
+    unlocked_rewards = ClaimRewards(message_id, user_id, total_points);
+  }
+  mutex_unique_lock.unlock();
+
+  if (!submissions_ledger_.Commit()) {
+    logger_.Error("Failed to commit ledger. Message id: '{}'. Rating: '{}'. User id: '{}'", message_id, rating, user_id);
+
+    mutex_unique_lock.lock();
+    ReleaseRewards(user_id, unlocked_rewards);
+    co_return false;
+  }
+
+  auto const announced_rewards = co_await AnnounceRewards(user_id, std::move(unlocked_rewards), priority);
+
+  logger_.Info("Finished changing rating. Message id: '{}'. Rating: '{}'", message_id, rating);
+
+  co_return announced_rewards;
+}
+
+size_t PokattoPrestige::ApplyRatingChange(SubmissionLedger::RatingChange const& rating_change) noexcept {
+  auto const& [user_id, timestamp, previous_rating, rating] = rating_change;
+
+  total_points_render_cache_.Invalidate(user_id);
+  monthly_points_render_cache_.Invalidate(user_id);
+
+  if (previous_rating <= rating) {
+    pokattos_monthly_points_.Increment(user_id, timestamp, rating - previous_rating);
+    return pokattos_total_points_.Increment(user_id, rating - previous_rating);
+  }
+
+  pokattos_monthly_points_.Decrement(user_id, timestamp, previous_rating - rating);
+  return pokattos_total_points_.Decrement(user_id, previous_rating - rating);
+}
+
+std::vector<Settings::Rewards> PokattoPrestige::ClaimRewards(dpp::snowflake const message_id, dpp::snowflake const user_id,
+                                                             size_t const total_points) noexcept {
+  auto const unlockable_rewards = pokattos_data_.GetOrAdd(user_id).GetUnlockableRewards(total_points, Settings::Get().GetRewardsPrices());
+
+  std::vector<Settings::Rewards> claimed_rewards;
+  for (size_t reward = static_cast<size_t>(Settings::Rewards::kBegin); unlockable_rewards.any() && (reward < static_cast<size_t>(Settings::Rewards::kEnd)); ++reward) {
     auto const reward_class = static_cast<Settings::Rewards>(reward);
-    if ((Settings::Get().GetRewardPrice(reward_class) > total_points) ||
-        (pokattos_data_.at(user_id).IsRewardUnlocked(reward_class))) {
+    if (!unlockable_rewards.test(reward) || !announcing_rewards_.emplace(user_id, reward_class).second) {
       continue;
     }
 
-    auto const reward_string = ::GetRewardString(reward_class);
-    logger_.Info("User unlocked reward. Message id: '{}'. Rating: '{}'. User id: '{}'. Reward: '{}'",
-                  message.id, rating, user_id, reward_string);
+    logger_.Info("User unlocked reward. Message id: '{}'. User id: '{}'. Reward: '{}'", message_id, user_id, ::GetRewardString(reward_class));
 
-    auto const reward_unlocked_message = fmt::format("User {} has unlocked **{}**", dpp::user::get_mention(user_id), reward_string);
-    if (!SendDirectMessage(Settings::Get().GetSquchanUserId(), reward_unlocked_message)) {
-      return false;
-    }
+    claimed_rewards.push_back(reward_class);
+  }
 
-    auto const user_reward_unlocked_message = fmt::format("You have unlocked **{}**", reward_string);
-    if (!SendDirectMessage(user_id, user_reward_unlocked_message)) {
-      return false;
-    }
+  return claimed_rewards;
+}
 
-    pokattos_data_.at(user_id).UnlockReward(reward_class);
+void PokattoPrestige::ReleaseRewards(dpp::snowflake const user_id, std::vector<Settings::Rewards> const& rewards) noexcept {
+  for (auto const reward : rewards) {
+    announcing_rewards_.erase({user_id, reward});
   }
+}
 
-  try {
-    auto const add_reaction_confirmation = bot_->message_add_reaction_sync(message, kProcessedMessageEmoji);
-    if (!add_reaction_confirmation.success) {
-      logger_.Error("Failed to add processed reaction. Message id: '{}'. User id: '{}'", message.id, user_id);
-      return false;
-    }
+dpp::task<bool> PokattoPrestige::AnnounceRewards(dpp::snowflake const user_id, std::vector<Settings::Rewards> const rewards,
+                                                 RestBudgeter::Priority const priority) noexcept {
+  if (rewards.empty()) {
+    co_return true;
   }
-  catch (dpp::exception const& rest_exception) {
-    logger_.Error("Failed to add processed reaction. Message id: '{}'. User id: '{}'. Exception: '{}'", message.id, user_id, rest_exception.what());
-    return false;
+
+  std::vector<std::string> squchan_reward_messages;
+  std::vector<std::string> user_reward_messages;
+  for (auto const reward : rewards) {
+    auto const reward_string = ::GetRewardString(reward);
+    squchan_reward_messages.push_back(fmt::format("User {} has unlocked **{}**", dpp::user::get_mention(user_id), reward_string));
+    user_reward_messages.push_back(fmt::format("You have unlocked **{}**", reward_string));
   }
 
-  logger_.Info("Finished processing rating. Message id: '{}'. Rating: '{}'", message.id, rating);
+  // Both recipients are messaged at once, each still gets its DMs in order
+  auto squchan_reward_messages_task = SendDirectMessages(Settings::Get().GetSquchanUserId(), std::move(squchan_reward_messages), priority);
+  auto user_reward_messages_task = SendDirectMessages(user_id, std::move(user_reward_messages), priority);
+
+  auto const sent_squchan_reward_messages = co_await std::move(squchan_reward_messages_task);
+  auto const sent_user_reward_messages = co_await std::move(user_reward_messages_task);
+
+  // A reward only counts as unlocked once both sides were told, otherwise it is announced again on the next rating
+  auto const announced_rewards = std::min(sent_squchan_reward_messages, sent_user_reward_messages);
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+    for (size_t reward = 0; reward < rewards.size(); ++reward) {
+      if ((reward < announced_rewards) && submissions_ledger_.RecordRewardUnlock({user_id, static_cast<size_t>(rewards[reward])})) {
+        pokattos_data_.GetOrAdd(user_id).UnlockReward(rewards[reward]);
+        snapshot_dirty_ = true;
+      }
+    }
 
-  return true;
+    ReleaseRewards(user_id, rewards);
+  }
+
+  // Unlocks must never be announced twice, so they are made durable straight away
+  if ((0 < announced_rewards) && !submissions_ledger_.Commit()) {
+    logger_.Error("Failed to commit reward unlocks. User id: '{}'", user_id);
+  }
+
+  co_return announced_rewards == rewards.size();
 }
 
-bool PokattoPrestige::GetMonthAndYearFromTimestamp(std::time_t const timestamp, int& month, int& year) const noexcept {
-  auto const local_time = std::localtime(&timestamp);
-  if (nullptr == local_time) {
-    logger_.Error("Failed to get month and year from timestamp. Timestamp: '{}'", timestamp);
-    return false;
+bool PokattoPrestige::ResolveProcessed(dpp::message const& message, bool& processed) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+  if (submissions_ledger_.Contains(message.id) || processed_messages_.contains(message.id)) {
+    processed = true;
+    return true;
   }
 
-  month = local_time->tm_mon;
-  year = local_time->tm_year;
+  auto const it_processed_reaction = std::find_if(message.reactions.cbegin(), message.reactions.cend(),
+                                                  [](auto const& reaction){ return kProcessedMessageEmoji == reaction.emoji_name; });
+  if (message.reactions.cend() == it_processed_reaction) {
+    processed = false;
+    return true;
+  }
 
-  return true;
+  // The reactions of a fetched message are seen from the bot's side, so me tells whether the bot placed the emoji.
+  // A reaction with no me flag can still come from a partial message, only then are the reaction users fetched.
+  if (it_processed_reaction->me) {
+    processed_messages_.insert(message.id);
+    processed = true;
+    return true;
+  }
+
+  return false;
 }
 
-bool PokattoPrestige::GetReactionUsers(dpp::message const& message, std::string const& emoji_name,
-                                       dpp::snowflake const emoji_id, dpp::user_map& reaction_users) const noexcept {
-  try {
-    auto const reaction = (emoji_id > 0) ? fmt::format("{}:{}", emoji_name, emoji_id) : emoji_name;
-    reaction_users = bot_->message_get_reactions_sync(message, reaction, {}, {}, std::numeric_limits<dpp::snowflake>::max());
-  } catch (dpp::exception const& rest_exception) {
-    logger_.Error("Failed to get message reactions. Message id: '{}'. Emoji name: '{}'. Exception: '{}'", message.id, emoji_name, rest_exception.what());
+dpp::task<bool> PokattoPrestige::GetReactionUsers(dpp::message const& message, std::string const& emoji_name, dpp::snowflake const emoji_id,
+                                                  RestBudgeter::Priority const priority, dpp::user_map& reaction_users) const noexcept {
+  auto const reaction = (emoji_id > 0) ? fmt::format("{}:{}", emoji_name, emoji_id) : emoji_name;
+  auto const reactions_result = co_await rest_budgeter_->Schedule(::GetRoute("reactions_get", message.channel_id), priority, [this, &message, &reaction]{
+    return discord_client_->MessageGetReactions(message, reaction, {}, {}, std::numeric_limits<dpp::snowflake>::max());
+  });
+  if (reactions_result.is_error()) {
+    logger_.Error("Failed to get message reactions. Message id: '{}'. Emoji name: '{}'. Error: '{}'", message.id, emoji_name, reactions_result.get_error().message);
+    co_return false;
+  }
+  reaction_users = reactions_result.get<dpp::user_map>();
+
+  co_return true;
+}
+
+bool PokattoPrestige::RecordPendingSubmission(dpp::message const& message) noexcept {
+  UpdateUsername(message.author.id, message.author.username);
+
+  std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+  auto const timestamp = static_cast<std::time_t>(message.get_creation_time());
+  if (!submissions_ledger_.RecordPending({message.id, message.channel_id, message.author.id, {}, timestamp})) {
+    logger_.Error("Failed to record pending submission in ledger. Message id: '{}'. User id: '{}'", message.id, message.author.id);
     return false;
   }
 
   return true;
 }
 
-bool PokattoPrestige::SendThreadPointsToUser(dpp::snowflake thread_id, dpp::snowflake user_id) const noexcept {
-  dpp::snowflake latest_message_id{};
-  dpp::message_map messages;
+dpp::task<bool> PokattoPrestige::SendThreadPointsToUser(dpp::snowflake const thread_id, dpp::snowflake const user_id,
+                                                        std::vector<SubmissionLedger::Submission> const& user_submissions) const noexcept {
+  // The header carries the total, so it is rendered once the submissions have been summed
   size_t total_user_points_in_thread{};
-  std::queue<std::string> submissions_info;
-  do {
-    try {
-      messages = bot_->messages_get_sync(thread_id, {}, {}, latest_message_id, kMaxMessagesPerGetCall);
-    } catch (dpp::exception const& rest_exception) {
-      logger_.Error("Failed to get submission thread messages. Thread id: '{}'. Exception: '{}'", thread_id, rest_exception.what());
-      return false;
+  for (auto const& submission : user_submissions) {
+    if ((submission.thread_id == thread_id) && submission.rated) {
+      total_user_points_in_thread += submission.rating;
     }
+  }
 
-    for (auto const& [message_id, message] : messages) {
-      if (message_id > latest_message_id) {
-        latest_message_id = message_id;
-      }
+  PageBuilder page_builder;
+  page_builder.AppendLine("**{} point{} for submissions in {}:**\n",
+                          total_user_points_in_thread, (total_user_points_in_thread == 1) ? "" : "s", ::GetThreadString(thread_id));
+  auto const server_id = Settings::Get().GetServerId();
+  for (auto const& submission : user_submissions) {
+    if (submission.thread_id != thread_id) {
+      continue;
+    }
 
-      if (message.author.id != user_id) {
-        continue;
-      }
+    if (!submission.rated) {
+      page_builder.AppendLine("Not rated: https://discord.com/channels/{}/{}/{} - ID: {}\n", server_id, thread_id, submission.message_id, submission.message_id);
+      continue;
+    }
 
-      auto const message_url = fmt::format("https://discord.com/channels/{}/{}/{}", Settings::Get().GetServerId(), thread_id, message_id);
+    auto const rating = submission.rating;
+    page_builder.AppendLine("{} point{}: https://discord.com/channels/{}/{}/{} - ID: {}\n",
+                            rating, (rating == 1) ? "" : "s", server_id, thread_id, submission.message_id, submission.message_id);
+  }
 
-      auto const it_rating_reaction = std::find_if(message.reactions.cbegin(), message.reactions.cend(),
-                                                   [this](auto const& reaction){ return rating_emojis_.contains(reaction.emoji_name); });
-      if (message.reactions.cend() == it_rating_reaction) {
-        submissions_info.push(fmt::format("Not rated: {} - ID: {}\n", message_url, message_id));
-        continue;
-      }
+  if (1 == page_builder.GetSectionLines()) {
+    page_builder.AppendLine("No entries");
+  }
 
-      dpp::user_map rating_reaction_users;
-      if (!GetReactionUsers(message, it_rating_reaction->emoji_name, it_rating_reaction->emoji_id, rating_reaction_users)) {
-        return false;
-      }
+  for (auto const page : page_builder.GetPages()) {
+    if (!co_await SendDirectMessage(user_id, std::string(page), RestBudgeter::Priority::kInteractive)) {
+      co_return false;
+    }
+  }
 
-      auto const has_squchan_reacted = std::any_of(rating_reaction_users.cbegin(), rating_reaction_users.cend(),
-                                                   [](auto const& user){ return Settings::Get().GetSquchanUserId() == user.first; });
-      if (!has_squchan_reacted) {
-        submissions_info.push(fmt::format("Not rated: {} - ID: {}\n", message_url, message_id));
-        continue;
-      }
+  co_return true;
+}
 
-      auto const rating = rating_emojis_.at(it_rating_reaction->emoji_name);
-      submissions_info.push(fmt::format("{} point{}: {} - ID: {}\n", rating, (rating == 1) ? "" : "s", message_url, message_id));
-      total_user_points_in_thread += rating;
-    }
-  } while (!messages.empty());
+dpp::task<bool> PokattoPrestige::SendDirectMessage(dpp::snowflake const user_id, std::string const message, RestBudgeter::Priority const priority) const noexcept {
+  auto const direct_message_result = co_await rest_budgeter_->Schedule(::GetRoute("direct_message_create", user_id), priority, [this, user_id, &message]{
+    return discord_client_->DirectMessageCreate(user_id, dpp::message(message));
+  });
+  if (direct_message_result.is_error()) {
+    logger_.Error("Failed to send direct message. User id: '{}'. Message: '{}' Error: '{}'", user_id, message, direct_message_result.get_error().message);
+    co_return false;
+  }
 
-  std::string submissions_log;
-  submissions_log.reserve(kMaxMessageLength);
-  submissions_log = fmt::format("**{} point{} for submissions in {}:**\n",
-                                total_user_points_in_thread, (total_user_points_in_thread == 1) ? "" : "s", ::GetThreadString(thread_id));
-  if (submissions_info.empty()) {
-    submissions_log.append("No entries");
-    if (!SendDirectMessage(user_id, submissions_log)) {
-      return false;
-    }
-  } else {
-    while (!submissions_info.empty()) {
-      ::AppendMessageContent(submissions_log, submissions_info);
-      if (!SendDirectMessage(user_id, submissions_log)) {
-        return false;
-      }
+  co_return true;
+}
 
-      submissions_log.clear();
+dpp::task<size_t> PokattoPrestige::SendDirectMessages(dpp::snowflake const user_id, std::vector<std::string> const messages,
+                                                      RestBudgeter::Priority const priority) const noexcept {
+  size_t sent_messages{};
+  for (auto const& message : messages) {
+    if (!co_await SendDirectMessage(user_id, message, priority)) {
+      break;
     }
+
+    ++sent_messages;
   }
 
-  return true;
+  co_return sent_messages;
 }
 
-bool PokattoPrestige::SendDirectMessage(dpp::snowflake const user_id, std::string const& message) const noexcept {
-  try {
-    bot_->direct_message_create_sync(user_id, dpp::message(message));
-  } catch (dpp::exception const& rest_exception) {
-    logger_.Error("Failed to send direct message. User id: '{}'. Message: '{}' Exception: '{}'", user_id, message, rest_exception.what());
-    return false;
+dpp::task<bool> PokattoPrestige::PublishLeaderboardPages(std::vector<std::string> const leaderboard_pages) noexcept {
+  // Without the ids of the published pages there is nothing to diff against, so start from an empty channel
+  if (!leaderboard_messages_.IsTracked()) {
+    if (!co_await ClearLeaderboardsMessages()) {
+      co_return false;
+    }
+
+    leaderboard_messages_.StorePages({});
   }
 
-  return true;
-}
+  // Pages are matched by position so the channel keeps the full leaderboard before the monthly one. Edits and deletes
+  // are independent of each other and run concurrently, new pages are created one by one to keep them in order.
+  auto published_pages = leaderboard_messages_.GetPages();
+  std::vector<std::pair<size_t, dpp::task<EditResult>>> edit_tasks;
+  for (size_t page = 0; page < std::min(leaderboard_pages.size(), published_pages.size()); ++page) {
+    if (published_pages[page].content != leaderboard_pages[page]) {
+      edit_tasks.emplace_back(page, EditLeaderboardMessage(published_pages[page].message_id, leaderboard_pages[page]));
+    }
+  }
 
-bool PokattoPrestige::ProcessLeaderboardEntries(std::string& leaderboard_message, std::queue<std::string>& leaderboard_entries) const noexcept {
-  if (leaderboard_entries.empty()) {
-    leaderboard_message.append("No entries");
-    if (!SendLeaderboardMessage(leaderboard_message)) {
-      return false;
+  std::vector<std::pair<size_t, dpp::task<bool>>> delete_tasks;
+  for (auto page = leaderboard_pages.size(); page < published_pages.size(); ++page) {
+    delete_tasks.emplace_back(page, DeleteLeaderboardMessage(published_pages[page].message_id));
+  }
+
+  auto published = true;
+  size_t created_pages{};
+  for (auto page = published_pages.size(); page < leaderboard_pages.size(); ++page) {
+    dpp::snowflake message_id{};
+    if (!co_await CreateLeaderboardMessage(leaderboard_pages[page], message_id)) {
+      published = false;
+      break;
     }
-  } else {
-    while (!leaderboard_entries.empty()) {
-      ::AppendMessageContent(leaderboard_message, leaderboard_entries);
-      if (!SendLeaderboardMessage(leaderboard_message)) {
-        return false;
-      }
 
-      leaderboard_message.clear();
+    published_pages.push_back({message_id, leaderboard_pages[page]});
+    ++created_pages;
+  }
+
+  auto missing = false;
+  for (auto& [page, edit_task] : edit_tasks) {
+    switch (co_await std::move(edit_task)) {
+      case EditResult::kEdited: { published_pages[page].content = leaderboard_pages[page]; break; }
+      case EditResult::kMissing: { missing = true; published = false; break; }
+      default: { published = false; break; }
     }
   }
 
-  return true;
+  // Pages that failed to delete stay tracked past the end, so the next update deletes them again
+  std::vector<bool> deleted_pages(published_pages.size());
+  for (auto& [page, delete_task] : delete_tasks) {
+    deleted_pages[page] = co_await std::move(delete_task);
+    published = deleted_pages[page] && published;
+  }
+
+  // Only a page deleted from the channel leaves nothing to edit, so the channel is cleared and published again
+  if (missing) {
+    leaderboard_messages_.Forget();
+    co_return false;
+  }
+
+  // Pages that failed to edit keep their old content, so the next update edits them again
+  std::vector<LeaderboardMessages::Page> stored_pages;
+  stored_pages.reserve(published_pages.size());
+  for (size_t page = 0; page < published_pages.size(); ++page) {
+    if ((page >= deleted_pages.size()) || !deleted_pages[page]) {
+      stored_pages.push_back(std::move(published_pages[page]));
+    }
+  }
+
+  if (!leaderboard_messages_.StorePages(std::move(stored_pages))) {
+    logger_.Error("Failed to store leaderboard messages");
+  }
+
+  if (!published) {
+    co_return false;
+  }
+
+  logger_.Info("Published leaderboard. Pages: '{}'. Edited: '{}'. Created: '{}'. Deleted: '{}'",
+               leaderboard_pages.size(), edit_tasks.size(), created_pages, delete_tasks.size());
+
+  co_return true;
 }
 
-bool PokattoPrestige::SendLeaderboardMessage(std::string const& leaderboard_message) const noexcept {
+dpp::task<bool> PokattoPrestige::CreateLeaderboardMessage(std::string const& leaderboard_message, dpp::snowflake& message_id) const noexcept {
   auto const message = dpp::message(Settings::Get().GetPokattoPrestigePathChannelId(), leaderboard_message);
-  try {
-    bot_->message_create_sync(message);
-  } catch (dpp::exception const& rest_exception) {
-    logger_.Error("Failed to send leaderboard message. Message: '{}'. Exception: '{}'", leaderboard_message, rest_exception.what());
-    return false;
+  auto const create_result = co_await rest_budgeter_->Schedule(::GetRoute("message_create", message.channel_id), RestBudgeter::Priority::kLeaderboard, [this, &message]{
+    return discord_client_->MessageCreate(message);
+  });
+  if (create_result.is_error()) {
+    logger_.Error("Failed to send leaderboard message. Message: '{}'. Error: '{}'", leaderboard_message, create_result.get_error().message);
+    co_return false;
   }
+  message_id = create_result.get<dpp::message>().id;
 
-  return true;
+  co_return true;
 }
 
-std::queue<std::string> PokattoPrestige::GetSortedLeaderboardEntries(bool const monthly) noexcept {
-  auto& pokattos_points = monthly ? pokattos_monthly_points_ : pokattos_total_points_;
-  pokattos_points.sort([](std::pair<dpp::snowflake, size_t> const& lhs, std::pair<dpp::snowflake, size_t> const& rhs){ return lhs.second > rhs.second; });
-
-  std::queue<std::string> leaderboard_entries;
-  std::for_each(pokattos_points.cbegin(), pokattos_points.cend(),
-                [this, &leaderboard_entries](std::pair<dpp::snowflake, size_t> const& rank_entry) { 
-                  if (rank_entry.second == 0) {
-                    return;
-                  }
-
-                  std::string username;
-                  try {
-                    auto const user = bot_->user_get_cached_sync(rank_entry.first);
-                    username = user.username;
-                  } catch (dpp::exception const& rest_exception) {
-                    logger_.Error("Failed to get user. User id: '{}'. Exception: '{}'", rank_entry.first, rest_exception.what());
-                    username = "?";
-                  }
-
-                  auto const leaderboard_string = fmt::format("{} point{}: {} - ({})\n",
-                                                              rank_entry.second,
-                                                              (rank_entry.second == 1) ? "" : "s",
-                                                              dpp::user::get_mention(rank_entry.first),
-                                                              username);
-                  leaderboard_entries.push(leaderboard_string);
-                });
-      
-  return leaderboard_entries;
+dpp::task<PokattoPrestige::EditResult> PokattoPrestige::EditLeaderboardMessage(dpp::snowflake const message_id, std::string const leaderboard_message) const noexcept {
+  auto message = dpp::message(Settings::Get().GetPokattoPrestigePathChannelId(), leaderboard_message);
+  message.id = message_id;
+  auto const edit_result = co_await rest_budgeter_->Schedule(::GetRoute("message_edit", message.channel_id), RestBudgeter::Priority::kLeaderboard, [this, &message]{
+    return discord_client_->MessageEdit(message);
+  });
+  if (edit_result.is_error()) {
+    logger_.Error("Failed to edit leaderboard message. Message id: '{}'. Error: '{}'", message_id, edit_result.get_error().message);
+    co_return (kNotFoundStatus == edit_result.http_info.status) ? EditResult::kMissing : EditResult::kFailed;
+  }
+
+  co_return EditResult::kEdited;
+}
+
+dpp::task<bool> PokattoPrestige::DeleteLeaderboardMessage(dpp::snowflake const message_id) const noexcept {
+  auto const channel_id = Settings::Get().GetPokattoPrestigePathChannelId();
+  auto const delete_result = co_await rest_budgeter_->Schedule(::GetRoute("message_delete", channel_id), RestBudgeter::Priority::kLeaderboard, [this, message_id, channel_id]{
+    return discord_client_->MessageDelete(message_id, channel_id);
+  });
+  // Already deleted from the channel, which is all a delete is for
+  if (delete_result.is_error() && (kNotFoundStatus != delete_result.http_info.status)) {
+    logger_.Error("Failed to delete leaderboard message. Message id: '{}'. Error: '{}'", message_id, delete_result.get_error().message);
+    co_return false;
+  }
+
+  co_return true;
 }
 
 void PokattoPrestige::Process() noexcept {
   while (process_submissions_) {
-    std::future<void> submission_future;
     {
       std::unique_lock<std::mutex> mutex_unique_lock(submissions_mutex_);
-      submission_condition_variable_.wait(mutex_unique_lock, [this]{ return !submissions_futures_.empty() || !process_submissions_; });
+      submission_condition_variable_.wait_for(mutex_unique_lock, std::min<std::chrono::steady_clock::duration>({kSnapshotInterval, kMetricsExportInterval,
+                                                                                                                Settings::Get().GetLeaderboardUpdateInterval()}),
+                                              [this]{ return process_requested_ || !process_submissions_; });
+      process_requested_ = false;
+    }
+
+    pending_jobs_gauge_.Set(static_cast<int64_t>(processing_executor_->GetPendingJobs()));
+
+    // Bursts of ratings publish at most once per interval, the last one is published as soon as the jobs drain
+    bool leaderboard_dirty{};
+    std::chrono::steady_clock::time_point last_leaderboard_update_time;
+    {
+      std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+      leaderboard_dirty = leaderboard_dirty_;
+      last_leaderboard_update_time = last_leaderboard_update_time_;
+    }
 
-      if (!submissions_futures_.empty()) {
-        submission_future = std::move(submissions_futures_.front());
-        submissions_futures_.pop();
+    // The backfill requests the first publish once it is done, partial leaderboards aren't published before that
+    if (leaderboard_dirty && !leaderboard_update_scheduled_ && (Readiness::kBackfilling != readiness_)) {
+      // A resync job runs for the whole crawl, so it doesn't hold back publishing the ratings around it
+      auto const submissions_drained = (processing_executor_->GetPendingJobs() == processing_executor_->GetPendingJobs(kResyncKey));
+      auto const leaderboard_update_due = (std::chrono::steady_clock::now() - last_leaderboard_update_time) >= Settings::Get().GetLeaderboardUpdateInterval();
+      if (submissions_drained || leaderboard_update_due) {
+        leaderboard_update_scheduled_ = true;
+        processing_executor_->Submit(kLeaderboardKey, [this]{
+          {
+            std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+            last_leaderboard_update_time_ = std::chrono::steady_clock::now();
+          }
+
+          PublishLeaderboardUpdate();
+          leaderboard_update_scheduled_ = false;
+        });
       }
     }
 
-    if (submission_future.valid()) {
-      submission_future.get();
+    // Pending submissions and crawl cursors don't need to be durable straight away, they are committed together here
+    if (!submissions_ledger_.Commit()) {
+      logger_.Error("Failed to commit ledger");
+    }
+
+    bool snapshot_due{};
+    {
+      std::lock_guard<std::mutex> const mutex_lock_guard(state_mutex_);
+      snapshot_due = snapshot_dirty_ && ((std::chrono::steady_clock::now() - last_snapshot_time_) >= kSnapshotInterval);
+    }
+
+    if (snapshot_due) {
+      StoreSnapshot();
+    }
+
+    if ((std::chrono::steady_clock::now() - last_metrics_export_time_) >= kMetricsExportInterval) {
+      last_metrics_export_time_ = std::chrono::steady_clock::now();
+      if (!MetricsRegistry::Get().StoreExport()) {
+        logger_.Error("Failed to export metrics");
+      }
+    }
+
+    if ((std::chrono::steady_clock::now() - last_metrics_time_) >= kMetricsInterval) {
+      LogMetrics();
     }
   }
 }
 
-void PokattoPrestige::QueueSubmission(std::function<void()> const& processing_function) noexcept {
-  std::lock_guard<std::mutex> const mutex_lock_guard(submissions_mutex_);
-  submissions_futures_.push(std::async(std::launch::deferred, processing_function));
+void PokattoPrestige::LogMetrics() noexcept {
+  last_metrics_time_ = std::chrono::steady_clock::now();
+
+  logger_.Info("Readiness: '{}'", ::GetReadinessString(readiness_));
+
+  for (size_t priority = static_cast<size_t>(RestBudgeter::Priority::kBegin); priority < static_cast<size_t>(RestBudgeter::Priority::kEnd); ++priority) {
+    auto const priority_class = static_cast<RestBudgeter::Priority>(priority);
+    auto const metrics = rest_budgeter_->GetMetrics(priority_class);
+    auto const mean_wait = (0 < metrics.throttled) ? (metrics.total_wait.count() / static_cast<int64_t>(metrics.throttled)) : int64_t{};
+    logger_.Info("REST budget. Priority: '{}'. Requests: '{}'. Queued: '{}'. Max queued: '{}'. Throttled: '{}'. Mean wait: '{}us'. Max wait: '{}us'",
+                 ::GetPriorityString(priority_class), metrics.requests, metrics.queued, metrics.max_queued, metrics.throttled,
+                 mean_wait, metrics.max_wait.count());
+  }
+
+  logger_.Info("REST budget. Too many requests: '{}'. Retried requests: '{}'. Reaction fetches: '{}'. Avoided reaction fetches: '{}'",
+               rest_budgeter_->GetTooManyRequests(), rest_budgeter_->GetRetriedRequests(), reaction_fetches_.load(), avoided_reaction_fetches_.load());
+
+  for (auto const& summary : MetricsRegistry::Get().GetSummaries()) {
+    logger_.Info("Metrics. {}", summary);
+  }
+}
+
+void PokattoPrestige::QueueSubmission(std::string const& key, std::function<void()> const& processing_function) noexcept {
+  processing_executor_->Submit(key, [this, processing_function, queued_time = std::chrono::steady_clock::now()]{
+    auto const start_time = std::chrono::steady_clock::now();
+    queue_wait_histogram_.Record(start_time - queued_time);
+
+    processing_function();
+    job_histogram_.Record(std::chrono::steady_clock::now() - start_time);
+
+    // Lets the scheduler publish the leaderboard as soon as the last pending job is done
+    NotifyProcess();
+  });
+}
+
+void PokattoPrestige::NotifyProcess() noexcept {
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(submissions_mutex_);
+    process_requested_ = true;
+  }
+
   submission_condition_variable_.notify_one();
 }
@@ -1,89 +1,207 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <future>
-#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
+#include <set>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <dpp/dpp.h>
 
+#include "discord/discord_client.h"
+#include "executor/keyed_executor.h"
+#include "filter/reaction_filter.h"
+#include "leaderboard/leaderboard.h"
+#include "leaderboard/leaderboard_messages.h"
+#include "leaderboard/leaderboard_render_cache.h"
+#include "leaderboard/leaderboard_renderer.h"
+#include "leaderboard/monthly_points.h"
+#include "ledger/submission_ledger.h"
+#include "pages/page_builder.h"
+#include "scheduler/rest_budgeter.h"
 #include "pokatto/pokatto_data.h"
+#include "pokatto/pokattos_data.h"
+#include "snapshot/prestige_snapshot.h"
+#include "metrics/metrics_registry.h"
 #include "settings/settings.h"
+#include "usernames/username_cache.h"
 #include "logger/logger_factory.h"
 
 class PokattoPrestige final {
 public:
+  // Points are served from the snapshot and ledger while the backfill crawls what was missed offline
+  enum class Readiness {
+    kBackfilling,
+    kReady,
+    kBackfillFailed
+  };
+
   PokattoPrestige() = delete;
   ~PokattoPrestige();
 
-  PokattoPrestige(std::shared_ptr<dpp::cluster> bot);
+  PokattoPrestige(std::shared_ptr<DiscordClient> discord_client, std::shared_ptr<RestBudgeter> rest_budgeter);
+
+  void AddRating(dpp::snowflake message_id, dpp::snowflake channel_id, dpp::snowflake reacting_user_id, std::string_view emoji_name) noexcept;
+  void RemoveRating(dpp::snowflake message_id, dpp::snowflake channel_id, dpp::snowflake reacting_user_id, std::string_view emoji_name) noexcept;
 
-  void AddRating(dpp::snowflake message_id, dpp::snowflake channel_id, dpp::snowflake reacting_user_id, std::string const& emoji_name) noexcept;
+  void AddSubmission(dpp::message const& message) noexcept;
 
   void SendPointsHistory(dpp::snowflake user_id) noexcept;
 
+  // Sends the given month's leaderboard, or the year to date one without a month
+  void SendLeaderboard(dpp::snowflake user_id, std::optional<std::chrono::year_month> month) noexcept;
+
   void ResyncMissedPoints() noexcept;
 
+  void UpdateUsername(dpp::snowflake user_id, std::string const& username) noexcept;
+
+  Readiness GetReadiness() const noexcept;
+  // Blocks until the backfill either finished or failed
+  void WaitForBackfill() const noexcept;
+
 private:
+  enum class EditResult {
+    kEdited,
+    kMissing,
+    kFailed
+  };
+
   bool IsSubmissionMessage(dpp::snowflake channel_id) const noexcept;
-  bool IsValidRating(dpp::snowflake user_id, std::string const& emoji_name) const noexcept;
 
-  bool ResyncAllPoints() noexcept;
+  bool RestoreFromSnapshot(uint64_t& ledger_generation) noexcept;
+  bool RestorePointsFromLedger(uint64_t ledger_generation) noexcept;
+  bool StoreSnapshot() noexcept;
+  void BackfillNewPoints() noexcept;
+  void SetReadiness(Readiness readiness) noexcept;
 
-  bool HandleMonthChange() noexcept;
+  void HandleMonthChange() noexcept;
 
-  bool ClearLeaderboardsMessages() const noexcept;
+  dpp::task<bool> ClearLeaderboardsMessages() const noexcept;
   bool UpdateLeaderboard() noexcept;
+  dpp::task<bool> RefreshUsernames() noexcept;
+  void RenderLeaderboard(std::vector<std::string>& leaderboard_pages) noexcept;
+  void RenderLeaderboard(std::optional<std::chrono::year_month> month, PageBuilder& page_builder) const noexcept;
+  void RequestLeaderboardUpdate() noexcept;
+  bool PublishLeaderboardUpdate() noexcept;
+
+  dpp::task<bool> ResyncThreadsPoints(bool from_cursors, bool skip_processed) noexcept;
+  dpp::task<bool> ResyncThreadPoints(dpp::snowflake thread_id, dpp::snowflake after_message_id, bool skip_processed,
+                                     std::atomic<size_t>& crawled_messages) noexcept;
+  dpp::task<dpp::confirmation_callback_t> GetThreadMessages(dpp::snowflake thread_id, dpp::snowflake after_message_id) noexcept;
+  dpp::task<bool> ResyncMessagePoints(dpp::message const& message, bool skip_processed) noexcept;
 
-  bool ResyncThreadPoints(dpp::snowflake thread_id, bool skip_processed) noexcept;
+  dpp::task<bool> ProcessRating(dpp::snowflake message_id, dpp::snowflake channel_id, size_t rating) noexcept;
+  dpp::task<bool> ProcessRating(dpp::message message, size_t rating, bool skip_processed, RestBudgeter::Priority priority) noexcept;
+  dpp::task<bool> ChangeRating(dpp::snowflake message_id, size_t rating, RestBudgeter::Priority priority) noexcept;
+  size_t ApplyRatingChange(SubmissionLedger::RatingChange const& rating_change) noexcept;
 
-  bool ProcessRating(dpp::snowflake message_id, dpp::snowflake channel_id, size_t rating) noexcept;
-  bool ProcessRating(dpp::message const& message, size_t rating, bool skip_processed) noexcept;
+  // Claiming and releasing need the state lock held, claimed rewards aren't claimed again until they are released
+  std::vector<Settings::Rewards> ClaimRewards(dpp::snowflake message_id, dpp::snowflake user_id, size_t total_points) noexcept;
+  void ReleaseRewards(dpp::snowflake user_id, std::vector<Settings::Rewards> const& rewards) noexcept;
+  dpp::task<bool> AnnounceRewards(dpp::snowflake user_id, std::vector<Settings::Rewards> rewards, RestBudgeter::Priority priority) noexcept;
 
-  bool GetMonthAndYearFromTimestamp(std::time_t timestamp, int& month, int& year) const noexcept;
+  bool ResolveProcessed(dpp::message const& message, bool& processed) noexcept;
 
-  bool GetReactionUsers(dpp::message const& message, std::string const& emoji_name, dpp::snowflake emoji_id, dpp::user_map& reaction_users) const noexcept;
+  dpp::task<bool> GetReactionUsers(dpp::message const& message, std::string const& emoji_name, dpp::snowflake emoji_id,
+                                   RestBudgeter::Priority priority, dpp::user_map& reaction_users) const noexcept;
 
-  bool SendThreadPointsToUser(dpp::snowflake thread_id, dpp::snowflake user_id) const noexcept;
-  bool SendDirectMessage(dpp::snowflake user_id, std::string const& message) const noexcept;
+  bool RecordPendingSubmission(dpp::message const& message) noexcept;
 
-  bool ProcessLeaderboardEntries(std::string& leaderboard_message, std::queue<std::string>& leaderboard_entries) const noexcept;
-  bool SendLeaderboardMessage(std::string const& leaderboard_message) const noexcept;
+  dpp::task<bool> SendThreadPointsToUser(dpp::snowflake thread_id, dpp::snowflake user_id,
+                                         std::vector<SubmissionLedger::Submission> const& user_submissions) const noexcept;
+  dpp::task<bool> SendDirectMessage(dpp::snowflake user_id, std::string message, RestBudgeter::Priority priority) const noexcept;
+  dpp::task<size_t> SendDirectMessages(dpp::snowflake user_id, std::vector<std::string> messages, RestBudgeter::Priority priority) const noexcept;
 
-  std::queue<std::string> GetSortedLeaderboardEntries(bool monthly) noexcept;
+  dpp::task<bool> PublishLeaderboardPages(std::vector<std::string> leaderboard_pages) noexcept;
+  dpp::task<bool> CreateLeaderboardMessage(std::string const& leaderboard_message, dpp::snowflake& message_id) const noexcept;
+  dpp::task<EditResult> EditLeaderboardMessage(dpp::snowflake message_id, std::string leaderboard_message) const noexcept;
+  dpp::task<bool> DeleteLeaderboardMessage(dpp::snowflake message_id) const noexcept;
 
   void Process() noexcept;
 
-  void QueueSubmission(std::function<void()> const& processing_function) noexcept;
+  void QueueSubmission(std::string const& key, std::function<void()> const& processing_function) noexcept;
+  void NotifyProcess() noexcept;
+  void LogMetrics() noexcept;
 
 private:
   Logger const logger_ = LoggerFactory::Get().Create("Pokatto Prestige");
   
-  std::shared_ptr<dpp::cluster> const bot_;
-
-  std::map<std::string, size_t> const rating_emojis_ = {{"x_", 0}, {"1️⃣", 1}, {"2️⃣", 2}, {"3️⃣", 3}, {"4️⃣", 4},
-                                                        {"5️⃣", 5}, {"6️⃣", 6}, {"7️⃣", 7}, {"8️⃣", 8}, {"9️⃣", 9}};
-
-  std::map<dpp::snowflake, PokattoData> pokattos_data_;
-  std::list<std::pair<dpp::snowflake, size_t>> pokattos_total_points_;
-  std::list<std::pair<dpp::snowflake, size_t>> pokattos_monthly_points_;
-
-  int current_month_ = {};
-  int current_year_ = {};
+  std::shared_ptr<DiscordClient> const discord_client_;
+  std::shared_ptr<RestBudgeter> const rest_budgeter_;
+
+  ReactionFilter reaction_filter_;
+
+  // Only touched from the leaderboard executor key
+  LeaderboardMessages leaderboard_messages_;
+
+  UsernameCache usernames_cache_{Settings::Get().GetUsernameCacheTtl()};
+
+  // Guards everything below up to the snapshot mutex, never held across an await. Taken before the ledger's own mutex.
+  mutable std::mutex state_mutex_;
+
+  PokattosData pokattos_data_;
+  std::set<std::pair<dpp::snowflake, Settings::Rewards>> announcing_rewards_;
+  std::unordered_set<dpp::snowflake> processed_messages_;
+  SubmissionLedger submissions_ledger_;
+  Leaderboard pokattos_total_points_;
+  MonthlyPoints pokattos_monthly_points_{Settings::Get().GetLeaderboardUtcOffset()};
+  LeaderboardRenderCache total_points_render_cache_;
+  LeaderboardRenderCache monthly_points_render_cache_;
+
+  bool leaderboard_dirty_ = false;
+  size_t requested_leaderboard_updates_ = {};
+  size_t published_leaderboard_updates_ = {};
+  size_t coalesced_leaderboard_updates_ = {};
+  std::chrono::steady_clock::time_point last_leaderboard_update_time_ = {};
+
+  bool snapshot_dirty_ = false;
+  std::chrono::steady_clock::time_point last_snapshot_time_ = std::chrono::steady_clock::now();
+  std::mutex snapshot_mutex_;
+
+  std::chrono::steady_clock::time_point last_metrics_time_ = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point last_metrics_export_time_ = {};
+  std::atomic<size_t> reaction_fetches_ = {};
+  std::atomic<size_t> avoided_reaction_fetches_ = {};
+
+  Histogram& queue_wait_histogram_ = MetricsRegistry::Get().GetHistogram("pokatto_prestige_queue_wait_seconds",
+                                                                         "Time jobs waited for a processing worker");
+  Histogram& job_histogram_ = MetricsRegistry::Get().GetHistogram("pokatto_prestige_job_seconds", "Time processing jobs took");
+  Histogram& rating_histogram_ = MetricsRegistry::Get().GetHistogram("pokatto_prestige_rating_seconds",
+                                                                     "Time ratings took from the reaction to being committed");
+  Counter& processed_ratings_counter_ = MetricsRegistry::Get().GetCounter("pokatto_prestige_ratings_total", "Ratings processed",
+                                                                          "result=\"processed\"");
+  Counter& failed_ratings_counter_ = MetricsRegistry::Get().GetCounter("pokatto_prestige_ratings_total", "Ratings processed",
+                                                                       "result=\"failed\"");
+  Histogram& usernames_histogram_ = MetricsRegistry::Get().GetHistogram("pokatto_prestige_leaderboard_seconds",
+                                                                        "Time leaderboard updates took per stage", "stage=\"usernames\"");
+  Histogram& render_histogram_ = MetricsRegistry::Get().GetHistogram("pokatto_prestige_leaderboard_seconds",
+                                                                     "Time leaderboard updates took per stage", "stage=\"render\"");
+  Histogram& publish_histogram_ = MetricsRegistry::Get().GetHistogram("pokatto_prestige_leaderboard_seconds",
+                                                                      "Time leaderboard updates took per stage", "stage=\"publish\"");
+  Gauge& pending_jobs_gauge_ = MetricsRegistry::Get().GetGauge("pokatto_prestige_pending_jobs", "Jobs queued or running on the processing workers");
+
+  std::atomic<Readiness> readiness_ = Readiness::kBackfilling;
 
   std::atomic<bool> process_submissions_ = true;
+  std::atomic<bool> leaderboard_update_scheduled_ = false;
   std::mutex submissions_mutex_;
+  bool process_requested_ = false;
   std::condition_variable submission_condition_variable_;
-  std::queue<std::future<void>> submissions_futures_;
+  std::unique_ptr<KeyedExecutor> processing_executor_;
 
-  std::thread process_submissions_thread_ = std::thread([this](){ Process(); });
+  std::thread process_submissions_thread_;
 };
\ No newline at end of file
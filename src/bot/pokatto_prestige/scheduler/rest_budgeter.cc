@@ -0,0 +1,262 @@
+#include "rest_budgeter.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "metrics/metrics_registry.h"
+
+namespace {
+  auto constexpr kGlobalRequestsPerSecond = 50.0;
+  auto constexpr kTooManyRequestsStatus = 429;
+  auto constexpr kMaxRetries = 3ULL;
+  auto constexpr kDispatchInterval = std::chrono::milliseconds(20);
+  auto constexpr kResumeWorkers = 4ULL;
+
+  std::array<char const*, static_cast<size_t>(RestBudgeter::Priority::kEnd)> constexpr kPrioritiesLabels = {
+    "priority=\"interactive\"",
+    "priority=\"rating\"",
+    "priority=\"leaderboard\"",
+    "priority=\"resync\""
+  };
+}
+
+RestBudgeter::RestBudgeter() :
+  RestBudgeter(kGlobalRequestsPerSecond) {
+}
+
+RestBudgeter::RestBudgeter(double const global_requests_per_second) :
+  global_requests_per_second_(global_requests_per_second),
+  global_tokens_(global_requests_per_second),
+  resume_executor_(kResumeWorkers) {
+  auto& metrics_registry = MetricsRegistry::Get();
+  for (size_t priority = static_cast<size_t>(Priority::kBegin); priority < static_cast<size_t>(Priority::kEnd); ++priority) {
+    priorities_wait_histograms_[priority] = &metrics_registry.GetHistogram("pokatto_prestige_rest_wait_seconds",
+                                                                           "Time REST calls waited for their budget",
+                                                                           kPrioritiesLabels[priority]);
+    priorities_request_histograms_[priority] = &metrics_registry.GetHistogram("pokatto_prestige_rest_request_seconds",
+                                                                              "Time REST calls took once dispatched",
+                                                                              kPrioritiesLabels[priority]);
+  }
+
+  dispatcher_thread_ = std::thread([this](){ Dispatch(); });
+}
+
+RestBudgeter::~RestBudgeter() {
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(budget_mutex_);
+    running_ = false;
+  }
+  budget_condition_variable_.notify_one();
+  dispatcher_thread_.join();
+  resume_executor_.Stop();
+}
+
+dpp::task<dpp::confirmation_callback_t> RestBudgeter::Schedule(std::string const route, Priority const priority,
+                                                               std::function<dpp::async<dpp::confirmation_callback_t>()> const request) noexcept {
+  for (size_t attempt = 0; ; ++attempt) {
+    auto const queued_time = std::chrono::steady_clock::now();
+    co_await Acquisition(*this, route, priority);
+
+    auto const dispatched_time = std::chrono::steady_clock::now();
+    auto result = co_await request();
+    // D++ completes requests on its own threads, callers go on to commit the ledger so they are moved off them
+    co_await Resumption(*this);
+    Release(route, result.http_info);
+
+    priorities_wait_histograms_[static_cast<size_t>(priority)]->Record(dispatched_time - queued_time);
+    priorities_request_histograms_[static_cast<size_t>(priority)]->Record(std::chrono::steady_clock::now() - dispatched_time);
+
+    if ((kTooManyRequestsStatus != result.http_info.status) || (kMaxRetries == attempt)) {
+      co_return result;
+    }
+
+    std::lock_guard<std::mutex> const mutex_lock_guard(budget_mutex_);
+    ++retried_requests_;
+  }
+}
+
+RestBudgeter::Metrics RestBudgeter::GetMetrics(Priority const priority) const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(budget_mutex_);
+  auto metrics = priorities_metrics_[static_cast<size_t>(priority)];
+  metrics.queued = priorities_waiters_[static_cast<size_t>(priority)].size();
+  return metrics;
+}
+
+size_t RestBudgeter::GetTooManyRequests() const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(budget_mutex_);
+  return too_many_requests_;
+}
+
+size_t RestBudgeter::GetRetriedRequests() const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(budget_mutex_);
+  return retried_requests_;
+}
+
+RestBudgeter::Acquisition::Acquisition(RestBudgeter& rest_budgeter, std::string const& route, Priority const priority) noexcept :
+  rest_budgeter_(rest_budgeter),
+  route_(route),
+  priority_(priority) {
+}
+
+bool RestBudgeter::Acquisition::await_ready() const noexcept {
+  return false;
+}
+
+bool RestBudgeter::Acquisition::await_suspend(std::coroutine_handle<> const handle) noexcept {
+  return rest_budgeter_.Enqueue(route_, priority_, handle);
+}
+
+void RestBudgeter::Acquisition::await_resume() const noexcept {
+}
+
+RestBudgeter::Resumption::Resumption(RestBudgeter& rest_budgeter) noexcept :
+  rest_budgeter_(rest_budgeter) {
+}
+
+bool RestBudgeter::Resumption::await_ready() const noexcept {
+  return false;
+}
+
+void RestBudgeter::Resumption::await_suspend(std::coroutine_handle<> const handle) noexcept {
+  rest_budgeter_.Resume(handle);
+}
+
+void RestBudgeter::Resumption::await_resume() const noexcept {
+}
+
+bool RestBudgeter::Enqueue(std::string const& route, Priority const priority, std::coroutine_handle<> const handle) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(budget_mutex_);
+  auto& metrics = priorities_metrics_[static_cast<size_t>(priority)];
+  ++metrics.requests;
+
+  // Only skips the queue when nobody of the same or a higher priority is already waiting, to keep each class FIFO
+  auto const waiting = std::any_of(priorities_waiters_.cbegin(), priorities_waiters_.cbegin() + static_cast<size_t>(priority) + 1,
+                                   [](auto const& waiters){ return !waiters.empty(); });
+  auto const now = std::chrono::steady_clock::now();
+  if (!waiting && TryAcquire(route, now)) {
+    return false;
+  }
+
+  auto& waiters = priorities_waiters_[static_cast<size_t>(priority)];
+  waiters.push_back({&route, handle, now});
+  ++metrics.throttled;
+  metrics.max_queued = std::max(metrics.max_queued, waiters.size());
+  budget_condition_variable_.notify_one();
+
+  return true;
+}
+
+bool RestBudgeter::TryAcquire(std::string const& route, std::chrono::steady_clock::time_point const now) noexcept {
+  if (now < global_reset_time_) {
+    return false;
+  }
+
+  auto const elapsed_seconds = std::chrono::duration<double>(now - global_refill_time_).count();
+  global_tokens_ = std::min(global_requests_per_second_, global_tokens_ + (elapsed_seconds * global_requests_per_second_));
+  global_refill_time_ = now;
+  if (global_tokens_ < 1.0) {
+    return false;
+  }
+
+  // Calls without a route, like interaction callbacks, only take from the global bucket
+  if (route.empty()) {
+    global_tokens_ -= 1.0;
+    return true;
+  }
+
+  auto& bucket = routes_buckets_[route];
+  if ((bucket.in_flight >= bucket.remaining) && (bucket.reset_time <= now)) {
+    bucket.remaining = bucket.limit;
+  }
+
+  if (bucket.in_flight >= bucket.remaining) {
+    return false;
+  }
+
+  global_tokens_ -= 1.0;
+  ++bucket.in_flight;
+
+  return true;
+}
+
+void RestBudgeter::Release(std::string const& route, dpp::http_request_completion_t const& http_info) noexcept {
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(budget_mutex_);
+    auto const now = std::chrono::steady_clock::now();
+    auto const retry_time = now + std::chrono::seconds(std::max<uint64_t>(http_info.ratelimit_retry_after, 1));
+
+    if (kTooManyRequestsStatus == http_info.status) {
+      ++too_many_requests_;
+
+      if (http_info.ratelimit_global) {
+        global_reset_time_ = std::max(global_reset_time_, retry_time);
+      }
+    }
+
+    if (!route.empty()) {
+      auto& bucket = routes_buckets_[route];
+      bucket.in_flight -= std::min<size_t>(bucket.in_flight, 1);
+
+      if ((kTooManyRequestsStatus == http_info.status) && !http_info.ratelimit_global) {
+        bucket.remaining = 0;
+        bucket.reset_time = std::max(bucket.reset_time, retry_time);
+      } else if ((kTooManyRequestsStatus != http_info.status) && (0 < http_info.ratelimit_limit)) {
+        bucket.limit = http_info.ratelimit_limit;
+        bucket.remaining = http_info.ratelimit_remaining;
+        bucket.reset_time = now + std::chrono::seconds(http_info.ratelimit_reset_after);
+      }
+    }
+  }
+
+  budget_condition_variable_.notify_one();
+}
+
+void RestBudgeter::Resume(std::coroutine_handle<> const handle) noexcept {
+  // Every continuation gets its own key so none of them waits on another's
+  resume_executor_.Submit(std::to_string(resumed_waiters_++), [handle]{ handle.resume(); });
+}
+
+void RestBudgeter::Dispatch() noexcept {
+  std::unique_lock<std::mutex> mutex_unique_lock(budget_mutex_);
+  while (running_) {
+    // Higher priorities pick first, a waiter whose route is spent doesn't hold back waiters on other routes
+    auto const now = std::chrono::steady_clock::now();
+    std::vector<std::coroutine_handle<>> acquired_handles;
+    auto waiting = false;
+    for (size_t priority = static_cast<size_t>(Priority::kBegin); priority < static_cast<size_t>(Priority::kEnd); ++priority) {
+      auto& waiters = priorities_waiters_[priority];
+      auto& metrics = priorities_metrics_[priority];
+      for (auto it_waiter = waiters.begin(); waiters.end() != it_waiter;) {
+        if (!TryAcquire(*it_waiter->route, now)) {
+          ++it_waiter;
+          continue;
+        }
+
+        auto const wait = std::chrono::duration_cast<std::chrono::microseconds>(now - it_waiter->queued_time);
+        metrics.total_wait += wait;
+        metrics.max_wait = std::max(metrics.max_wait, wait);
+
+        acquired_handles.push_back(it_waiter->handle);
+        it_waiter = waiters.erase(it_waiter);
+      }
+
+      waiting = waiting || !waiters.empty();
+    }
+
+    if (!acquired_handles.empty()) {
+      for (auto const handle : acquired_handles) {
+        Resume(handle);
+      }
+      continue;
+    }
+
+    // Tokens refill with time as well as with responses, so waiters are polled while there are any
+    if (waiting) {
+      budget_condition_variable_.wait_for(mutex_unique_lock, kDispatchInterval);
+    } else {
+      budget_condition_variable_.wait(mutex_unique_lock);
+    }
+  }
+}
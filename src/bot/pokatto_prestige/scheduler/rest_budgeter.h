@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <dpp/dpp.h>
+
+#include "executor/keyed_executor.h"
+#include "metrics/histogram.h"
+
+// Keeps REST calls within the global and per route rate limits, handing out tokens highest priority first. Calls with
+// an empty route only take a global token.
+class RestBudgeter final {
+public:
+  enum class Priority : size_t {
+    kBegin = 0,
+    kInteractive = 0,
+    kRating,
+    kLeaderboard,
+    kResync,
+    kEnd
+  };
+
+  struct Metrics final {
+    size_t requests = {};
+    size_t queued = {};
+    size_t max_queued = {};
+    size_t throttled = {};
+    std::chrono::microseconds total_wait = {};
+    std::chrono::microseconds max_wait = {};
+  };
+
+  RestBudgeter();
+  ~RestBudgeter();
+
+  RestBudgeter(double global_requests_per_second);
+
+  dpp::task<dpp::confirmation_callback_t> Schedule(std::string route, Priority priority,
+                                                   std::function<dpp::async<dpp::confirmation_callback_t>()> request) noexcept;
+
+  Metrics GetMetrics(Priority priority) const noexcept;
+  size_t GetTooManyRequests() const noexcept;
+  size_t GetRetriedRequests() const noexcept;
+
+private:
+  struct Bucket final {
+    uint64_t limit = 1;
+    uint64_t remaining = 1;
+    size_t in_flight = {};
+    std::chrono::steady_clock::time_point reset_time = {};
+  };
+
+  struct Waiter final {
+    std::string const* route = {};
+    std::coroutine_handle<> handle = {};
+    std::chrono::steady_clock::time_point queued_time = {};
+  };
+
+  class Acquisition final {
+  public:
+    Acquisition() = delete;
+    ~Acquisition() = default;
+
+    Acquisition(RestBudgeter& rest_budgeter, std::string const& route, Priority priority) noexcept;
+
+    bool await_ready() const noexcept;
+    bool await_suspend(std::coroutine_handle<> handle) noexcept;
+    void await_resume() const noexcept;
+
+  private:
+    RestBudgeter& rest_budgeter_;
+    std::string const& route_;
+    Priority const priority_;
+  };
+
+  class Resumption final {
+  public:
+    Resumption() = delete;
+    ~Resumption() = default;
+
+    Resumption(RestBudgeter& rest_budgeter) noexcept;
+
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> handle) noexcept;
+    void await_resume() const noexcept;
+
+  private:
+    RestBudgeter& rest_budgeter_;
+  };
+
+  bool Enqueue(std::string const& route, Priority priority, std::coroutine_handle<> handle) noexcept;
+  bool TryAcquire(std::string const& route, std::chrono::steady_clock::time_point now) noexcept;
+  void Release(std::string const& route, dpp::http_request_completion_t const& http_info) noexcept;
+  void Resume(std::coroutine_handle<> handle) noexcept;
+
+  void Dispatch() noexcept;
+
+private:
+  double const global_requests_per_second_ = {};
+
+  mutable std::mutex budget_mutex_;
+  std::condition_variable budget_condition_variable_;
+  bool running_ = true;
+
+  double global_tokens_ = {};
+  std::chrono::steady_clock::time_point global_refill_time_ = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point global_reset_time_ = {};
+  std::unordered_map<std::string, Bucket> routes_buckets_;
+
+  std::array<std::list<Waiter>, static_cast<size_t>(Priority::kEnd)> priorities_waiters_;
+  std::array<Metrics, static_cast<size_t>(Priority::kEnd)> priorities_metrics_;
+  size_t too_many_requests_ = {};
+  size_t retried_requests_ = {};
+
+  std::array<Histogram*, static_cast<size_t>(Priority::kEnd)> priorities_wait_histograms_ = {};
+  std::array<Histogram*, static_cast<size_t>(Priority::kEnd)> priorities_request_histograms_ = {};
+
+  // Continuations can block on fsyncs or the state lock, so they never run on the dispatcher or on D++ threads
+  KeyedExecutor resume_executor_;
+  std::atomic<size_t> resumed_waiters_ = {};
+
+  std::thread dispatcher_thread_;
+};
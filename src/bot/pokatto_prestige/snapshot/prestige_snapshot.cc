@@ -0,0 +1,279 @@
+#include "prestige_snapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "pokatto_prestige/storage/durable_file.h"
+
+namespace {
+  auto constexpr kSnapshotFilePath = "state/snapshot.bin";
+  auto constexpr kTemporarySnapshotFilePath = "state/snapshot.bin.tmp";
+  auto constexpr kSnapshotMagic = std::string_view("PKPSNAP", 8);
+  auto constexpr kSnapshotVersion = uint32_t{1};
+
+  static_assert(std::endian::native == std::endian::little, "Snapshot records are stored little-endian");
+
+  // Every record is made of 8 byte fields so the snapshot can be used straight from a memory mapping
+  struct SnapshotHeader final {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t checksum;
+    uint64_t body_size;
+  };
+
+  struct SnapshotMetadata final {
+    uint64_t ledger_generation;
+    uint64_t total_points_count;
+    uint64_t unlocked_rewards_count;
+    uint64_t threads_cursors_count;
+    uint64_t submissions_count;
+  };
+
+  struct PairRecord final {
+    uint64_t key;
+    uint64_t value;
+  };
+
+  struct SubmissionRecord final {
+    uint64_t message_id;
+    uint64_t thread_id;
+    uint64_t user_id;
+    uint64_t rating;
+    int64_t timestamp;
+    uint64_t rated;
+  };
+
+  static_assert(sizeof(SnapshotHeader) == 32);
+  static_assert(sizeof(SnapshotMetadata) == 40);
+  static_assert(sizeof(PairRecord) == 16);
+  static_assert(sizeof(SubmissionRecord) == 48);
+
+  uint64_t ComputeChecksum(std::span<std::byte const> const data) noexcept {
+    // FNV-1a
+    auto checksum = uint64_t{14695981039346656037ULL};
+    for (auto const byte : data) {
+      checksum ^= static_cast<uint64_t>(byte);
+      checksum *= uint64_t{1099511628211ULL};
+    }
+
+    return checksum;
+  }
+
+  template <typename Record>
+  void AppendRecord(std::vector<std::byte>& buffer, Record const& record) noexcept {
+    auto const offset = buffer.size();
+    buffer.resize(offset + sizeof(Record));
+    std::memcpy(buffer.data() + offset, &record, sizeof(Record));
+  }
+
+  template <typename Record>
+  bool ReadRecords(std::span<std::byte const>& body, uint64_t const count, std::vector<Record>& records) noexcept {
+    if ((body.size() / sizeof(Record)) < count) {
+      return false;
+    }
+
+    records.resize(count);
+    std::memcpy(records.data(), body.data(), count * sizeof(Record));
+    body = body.subspan(count * sizeof(Record));
+
+    return true;
+  }
+
+  class MappedFile final {
+  public:
+    MappedFile() = delete;
+    MappedFile(MappedFile const&) = delete;
+    void operator=(MappedFile const&) = delete;
+
+    explicit MappedFile(char const* const file_path) noexcept {
+#ifdef _WIN32
+      file_ = CreateFileA(file_path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (INVALID_HANDLE_VALUE == file_) {
+        return;
+      }
+
+      LARGE_INTEGER file_size{};
+      if (!GetFileSizeEx(file_, &file_size) || (0 == file_size.QuadPart)) {
+        return;
+      }
+
+      mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (nullptr == mapping_) {
+        return;
+      }
+
+      auto const view = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+      if (nullptr != view) {
+        data_ = std::span<std::byte const>(static_cast<std::byte const*>(view), static_cast<size_t>(file_size.QuadPart));
+      }
+#else
+      auto const file_descriptor = open(file_path, O_RDONLY);
+      if (-1 == file_descriptor) {
+        return;
+      }
+
+      struct stat file_stat{};
+      if ((0 == fstat(file_descriptor, &file_stat)) && (0 < file_stat.st_size)) {
+        auto const view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        if (MAP_FAILED != view) {
+          data_ = std::span<std::byte const>(static_cast<std::byte const*>(view), static_cast<size_t>(file_stat.st_size));
+        }
+      }
+
+      close(file_descriptor);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+      if (!data_.empty()) {
+        UnmapViewOfFile(data_.data());
+      }
+
+      if (nullptr != mapping_) {
+        CloseHandle(mapping_);
+      }
+
+      if (INVALID_HANDLE_VALUE != file_) {
+        CloseHandle(file_);
+      }
+#else
+      if (!data_.empty()) {
+        munmap(const_cast<std::byte*>(data_.data()), data_.size());
+      }
+#endif
+    }
+
+    std::span<std::byte const> GetData() const noexcept {
+      return data_;
+    }
+
+  private:
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+    std::span<std::byte const> data_;
+  };
+}
+
+bool PrestigeSnapshot::ReadSnapshot(State& state) noexcept {
+  MappedFile const snapshot_file(kSnapshotFilePath);
+  auto const snapshot = snapshot_file.GetData();
+  if (snapshot.size() < sizeof(SnapshotHeader)) {
+    return false;
+  }
+
+  SnapshotHeader header{};
+  std::memcpy(&header, snapshot.data(), sizeof(SnapshotHeader));
+  if ((std::string_view(header.magic.data(), header.magic.size()) != kSnapshotMagic) ||
+      (kSnapshotVersion != header.version) ||
+      ((snapshot.size() - sizeof(SnapshotHeader)) != header.body_size)) {
+    return false;
+  }
+
+  auto body = snapshot.subspan(sizeof(SnapshotHeader));
+  if (ComputeChecksum(body) != header.checksum) {
+    return false;
+  }
+
+  if (body.size() < sizeof(SnapshotMetadata)) {
+    return false;
+  }
+
+  SnapshotMetadata metadata{};
+  std::memcpy(&metadata, body.data(), sizeof(SnapshotMetadata));
+  body = body.subspan(sizeof(SnapshotMetadata));
+
+  std::vector<PairRecord> total_points;
+  std::vector<PairRecord> unlocked_rewards;
+  std::vector<PairRecord> threads_cursors;
+  std::vector<SubmissionRecord> submissions;
+  if (!::ReadRecords(body, metadata.total_points_count, total_points) ||
+      !::ReadRecords(body, metadata.unlocked_rewards_count, unlocked_rewards) ||
+      !::ReadRecords(body, metadata.threads_cursors_count, threads_cursors) ||
+      !::ReadRecords(body, metadata.submissions_count, submissions) ||
+      !body.empty()) {
+    return false;
+  }
+
+  state.ledger_generation = metadata.ledger_generation;
+
+  state.total_points.clear();
+  for (auto const& record : total_points) {
+    state.total_points.emplace_back(record.key, static_cast<size_t>(record.value));
+  }
+
+  state.unlocked_rewards.clear();
+  for (auto const& record : unlocked_rewards) {
+    state.unlocked_rewards.emplace_back(record.key, record.value);
+  }
+
+  state.threads_cursors.clear();
+  for (auto const& record : threads_cursors) {
+    state.threads_cursors.emplace_back(record.key, record.value);
+  }
+
+  state.submissions.clear();
+  state.submissions.reserve(submissions.size());
+  for (auto const& record : submissions) {
+    state.submissions.push_back({record.message_id, record.thread_id, record.user_id,
+                                 static_cast<size_t>(record.rating), static_cast<std::time_t>(record.timestamp), (0 != record.rated)});
+  }
+
+  return true;
+}
+
+bool PrestigeSnapshot::StoreSnapshot(State const& state) noexcept {
+  std::vector<std::byte> snapshot;
+  snapshot.reserve(sizeof(SnapshotHeader) + sizeof(SnapshotMetadata) +
+                   (state.total_points.size() + state.unlocked_rewards.size() + state.threads_cursors.size()) * sizeof(PairRecord) +
+                   state.submissions.size() * sizeof(SubmissionRecord));
+
+  ::AppendRecord(snapshot, SnapshotHeader{});
+  ::AppendRecord(snapshot, SnapshotMetadata{state.ledger_generation, state.total_points.size(), state.unlocked_rewards.size(),
+                                            state.threads_cursors.size(), state.submissions.size()});
+
+  for (auto const& [user_id, points] : state.total_points) {
+    ::AppendRecord(snapshot, PairRecord{user_id, points});
+  }
+
+  for (auto const& [user_id, unlocked_rewards_mask] : state.unlocked_rewards) {
+    ::AppendRecord(snapshot, PairRecord{user_id, unlocked_rewards_mask});
+  }
+
+  for (auto const& [thread_id, message_id] : state.threads_cursors) {
+    ::AppendRecord(snapshot, PairRecord{thread_id, message_id});
+  }
+
+  for (auto const& submission : state.submissions) {
+    ::AppendRecord(snapshot, SubmissionRecord{submission.message_id, submission.thread_id, submission.user_id,
+                                              submission.rating, static_cast<int64_t>(submission.timestamp), submission.rated});
+  }
+
+  auto const body = std::span<std::byte const>(snapshot).subspan(sizeof(SnapshotHeader));
+
+  SnapshotHeader header{};
+  std::copy(kSnapshotMagic.cbegin(), kSnapshotMagic.cend(), header.magic.begin());
+  header.version = kSnapshotVersion;
+  header.checksum = ::ComputeChecksum(body);
+  header.body_size = body.size();
+  std::memcpy(snapshot.data(), &header, sizeof(SnapshotHeader));
+
+  // Ledger generations are compacted once this returns, so the rename must not be lost in a crash
+  return DurableFile::Replace(kSnapshotFilePath, kTemporarySnapshotFilePath, snapshot);
+}
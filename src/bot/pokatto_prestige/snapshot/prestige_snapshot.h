@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+#include "pokatto_prestige/ledger/submission_ledger.h"
+
+class PrestigeSnapshot final {
+public:
+  struct State final {
+    uint64_t ledger_generation = {};
+    std::vector<std::pair<dpp::snowflake, size_t>> total_points;
+    std::vector<std::pair<dpp::snowflake, uint64_t>> unlocked_rewards;
+    std::vector<std::pair<dpp::snowflake, dpp::snowflake>> threads_cursors;
+    std::vector<SubmissionLedger::Submission> submissions;
+  };
+
+  PrestigeSnapshot() = delete;
+  ~PrestigeSnapshot() = delete;
+
+  static bool ReadSnapshot(State& state) noexcept;
+  static bool StoreSnapshot(State const& state) noexcept;
+};
@@ -0,0 +1,65 @@
+#include "durable_file.h"
+
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool DurableFile::Write(std::FILE* const file, std::span<std::byte const> const data) noexcept {
+  auto written = (data.size() == std::fwrite(data.data(), 1, data.size(), file)) && (0 == std::fflush(file));
+#ifdef _WIN32
+  written = written && (0 == _commit(_fileno(file)));
+#else
+  written = written && (0 == fsync(fileno(file)));
+#endif
+
+  return written;
+}
+
+bool DurableFile::Replace(char const* const file_path, char const* const temporary_file_path, std::span<std::byte const> const data) noexcept {
+  auto const temporary_file = std::fopen(temporary_file_path, "wb");
+  if (nullptr == temporary_file) {
+    return false;
+  }
+
+  auto const written = Write(temporary_file, data);
+  if ((0 != std::fclose(temporary_file)) || !written) {
+    return false;
+  }
+
+  std::error_code error_code;
+  std::filesystem::rename(temporary_file_path, file_path, error_code);
+  if (error_code) {
+    return false;
+  }
+
+  std::string directory_path;
+  try {
+    directory_path = std::filesystem::path(file_path).parent_path().string();
+  } catch (std::exception const& exception) {
+    return false;
+  }
+
+  return SyncDirectory(directory_path.empty() ? "." : directory_path.c_str());
+}
+
+bool DurableFile::SyncDirectory(char const* const directory_path) noexcept {
+#ifdef _WIN32
+  return true;
+#else
+  auto const directory_descriptor = open(directory_path, O_RDONLY);
+  if (-1 == directory_descriptor) {
+    return false;
+  }
+
+  auto const synced = (0 == fsync(directory_descriptor));
+  return (0 == close(directory_descriptor)) && synced;
+#endif
+}
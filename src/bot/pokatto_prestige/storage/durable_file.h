@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <span>
+
+class DurableFile final {
+public:
+  DurableFile() = delete;
+  ~DurableFile() = delete;
+
+  static bool Write(std::FILE* file, std::span<std::byte const> data) noexcept;
+  // Readers see either the old file or the whole new one, never a partial write
+  static bool Replace(char const* file_path, char const* temporary_file_path, std::span<std::byte const> data) noexcept;
+  // A created or renamed file is only durable once the directory holding it is synced
+  static bool SyncDirectory(char const* directory_path) noexcept;
+};
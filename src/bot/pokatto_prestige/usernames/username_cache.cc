@@ -0,0 +1,133 @@
+#include "username_cache.h"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <span>
+
+#include <nlohmann/json.hpp>
+
+#include "pokatto_prestige/storage/durable_file.h"
+
+namespace {
+  auto constexpr kStateDirectory = "state";
+  auto constexpr kUsernamesFilePath = "state/usernames.json";
+  auto constexpr kTemporaryUsernamesFilePath = "state/usernames.json.tmp";
+  auto constexpr kUsernamesKey = "usernames";
+  auto constexpr kUserIdKey = "user_id";
+  auto constexpr kUsernameKey = "username";
+  auto constexpr kUpdateTimeKey = "update_time";
+}
+
+UsernameCache::UsernameCache(std::chrono::seconds const ttl) :
+  ttl_(ttl) {
+  if (!std::filesystem::exists(kStateDirectory) && !std::filesystem::create_directory(kStateDirectory)) {
+    throw std::runtime_error("Failed to create state directory");
+  }
+
+  if (!std::filesystem::exists(kUsernamesFilePath)) {
+    return;
+  }
+
+  try {
+    std::ifstream usernames_file(kUsernamesFilePath);
+    auto const usernames_json = nlohmann::json::parse(usernames_file);
+
+    for (auto const& username_json : usernames_json[kUsernamesKey]) {
+      users_usernames_[username_json[kUserIdKey].get<dpp::snowflake>()] = {username_json[kUsernameKey].get<std::string>(),
+                                                                            username_json[kUpdateTimeKey].get<std::time_t>()};
+    }
+  } catch (std::exception const& exception) {
+    // Usernames are looked up again on the next leaderboard update, so a bad file only costs some requests
+    logger_.Error("Failed to read usernames, starting empty. Error: '{}'", exception.what());
+    users_usernames_.clear();
+  }
+}
+
+bool UsernameCache::GetUsername(dpp::snowflake const user_id, std::string& username) const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(usernames_mutex_);
+  auto const it_user_username = users_usernames_.find(user_id);
+  if (users_usernames_.cend() == it_user_username) {
+    return false;
+  }
+
+  username = it_user_username->second.username;
+  return true;
+}
+
+std::vector<dpp::snowflake> UsernameCache::GetStaleUsers(std::vector<dpp::snowflake> const& users_ids) const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(usernames_mutex_);
+  auto const stale_time = std::time(nullptr) - ttl_.count();
+
+  std::vector<dpp::snowflake> stale_users_ids;
+  for (auto const user_id : users_ids) {
+    auto const it_user_username = users_usernames_.find(user_id);
+    if ((users_usernames_.cend() == it_user_username) || (it_user_username->second.update_time < stale_time)) {
+      stale_users_ids.push_back(user_id);
+    }
+  }
+
+  return stale_users_ids;
+}
+
+bool UsernameCache::Update(dpp::snowflake const user_id, std::string const& username) noexcept {
+  if (username.empty()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> const mutex_lock_guard(usernames_mutex_);
+  auto const update_time = std::time(nullptr);
+  auto& entry = users_usernames_[user_id];
+  auto const changed = (entry.username != username);
+
+  // Member events repeat unchanged usernames all the time, those only refresh entries the TTL would look up again
+  if (!changed && (entry.update_time >= (update_time - ttl_.count()))) {
+    return false;
+  }
+
+  entry = {username, update_time};
+  ++changes_;
+
+  return changed;
+}
+
+bool UsernameCache::Store() noexcept {
+  nlohmann::json usernames_json;
+  uint64_t changes{};
+  {
+    std::lock_guard<std::mutex> const mutex_lock_guard(usernames_mutex_);
+    if (stored_changes_ == changes_) {
+      return true;
+    }
+
+    auto& users_json = usernames_json[kUsernamesKey];
+    users_json = nlohmann::json::array();
+    for (auto const& [user_id, entry] : users_usernames_) {
+      nlohmann::json username_json;
+      username_json[kUserIdKey] = static_cast<uint64_t>(user_id);
+      username_json[kUsernameKey] = entry.username;
+      username_json[kUpdateTimeKey] = entry.update_time;
+      users_json.push_back(username_json);
+    }
+    changes = changes_;
+  }
+
+  std::string usernames;
+  try {
+    usernames = usernames_json.dump();
+  } catch (std::exception const& exception) {
+    logger_.Error("Failed to serialise usernames. Error: '{}'", exception.what());
+    return false;
+  }
+
+  if (!DurableFile::Replace(kUsernamesFilePath, kTemporaryUsernamesFilePath, std::as_bytes(std::span(usernames)))) {
+    return false;
+  }
+
+  // Changes made while writing are left for the next store
+  std::lock_guard<std::mutex> const mutex_lock_guard(usernames_mutex_);
+  stored_changes_ = std::max(stored_changes_, changes);
+
+  return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dpp/dpp.h>
+
+#include "logger/logger_factory.h"
+
+// Usernames shown on the leaderboard, persisted and looked up again once older than the TTL
+class UsernameCache final {
+public:
+  UsernameCache() = delete;
+  ~UsernameCache() = default;
+
+  UsernameCache(std::chrono::seconds ttl);
+
+  bool GetUsername(dpp::snowflake user_id, std::string& username) const noexcept;
+  std::vector<dpp::snowflake> GetStaleUsers(std::vector<dpp::snowflake> const& users_ids) const noexcept;
+
+  // Returns whether the username differs from the cached one
+  bool Update(dpp::snowflake user_id, std::string const& username) noexcept;
+
+  bool Store() noexcept;
+
+private:
+  struct Entry final {
+    std::string username;
+    std::time_t update_time = {};
+  };
+
+  Logger const logger_ = LoggerFactory::Get().Create("Username Cache");
+
+  std::chrono::seconds const ttl_ = {};
+
+  mutable std::mutex usernames_mutex_;
+  std::unordered_map<dpp::snowflake, Entry> users_usernames_;
+  uint64_t changes_ = {};
+  uint64_t stored_changes_ = {};
+};
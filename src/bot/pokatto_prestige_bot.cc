@@ -1,29 +1,65 @@
 #include "pokatto_prestige_bot.h"
 
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <variant>
+
 namespace {
   auto constexpr kGetPointsHistorySlashCommand = "get_points_history";
+  auto constexpr kGetLeaderboardSlashCommand = "get_leaderboard";
+  auto constexpr kMonthOption = "month";
   auto constexpr kResyncMissedPointsSlashCommand = "resync_missed_points";
-}
 
-PokattoPrestigeBot::PokattoPrestigeBot(bool const deploy_slash_commands, bool const welcome_squchan) {
-  bot_->on_log([this](dpp::log_t const& event) { OnLog(event); });
-  bot_->on_message_reaction_add([this](dpp::message_reaction_add_t const& message_reaction_add) { OnMessageReactionAdd(message_reaction_add); });
-  bot_->on_ready([this](dpp::ready_t const& ready) { OnReady(ready); });
-  bot_->on_slashcommand([this](dpp::slashcommand_t const& slash_command) { OnSlashCommand(slash_command); });
+  // Months are given as YYYY-MM
+  bool ParseMonth(std::string const& month_string, std::chrono::year_month& month) noexcept {
+    int year{};
+    unsigned month_number{};
+    if (2 != std::sscanf(month_string.c_str(), "%d-%u", &year, &month_number)) {
+      return false;
+    }
 
-  bot_->direct_message_create_sync(Settings::Get().GetFolleUserId(), dpp::message("INITIALISING BOT"));
+    month = std::chrono::year(year) / std::chrono::month(month_number);
+    return month.ok();
+  }
 
-  if (deploy_slash_commands) {
-    DeploySlashCommands();
+  // Replies to commands that read points tell when those points may still be missing some ratings
+  std::string GetReadinessNote(PokattoPrestige::Readiness const readiness) noexcept {
+    switch (readiness) {
+      case PokattoPrestige::Readiness::kBackfilling: {
+        return " The bot is still catching up on points given while it was offline, those may not be included yet.";
+      }
+      case PokattoPrestige::Readiness::kBackfillFailed: {
+        return " The bot failed to catch up on points given while it was offline, those may be missing until SquChan resyncs them.";
+      }
+      default: { return {}; }
+    }
   }
 
-  if (welcome_squchan) {
-    bot_->direct_message_create_sync(Settings::Get().GetSquchanUserId(), dpp::message("Hello Squ! Welcome to the Pokatto Prestige Bot!"));
+  // Each interaction has its own callback route, so replies only take from the global budget and never queue behind
+  // each other. The event owns the interaction, so it is copied into the job.
+  dpp::job ReplyToSlashCommand(std::shared_ptr<RestBudgeter> const rest_budgeter, dpp::slashcommand_t const slash_command, dpp::message const reply) {
+    co_await rest_budgeter->Schedule({}, RestBudgeter::Priority::kInteractive, [&slash_command, &reply]{
+      return slash_command.co_reply(reply);
+    });
   }
+}
 
-  pokatto_prestige_ = std::make_unique<PokattoPrestige>(bot_);
+PokattoPrestigeBot::PokattoPrestigeBot(bool const deploy_slash_commands, bool const welcome_squchan) :
+  deploy_slash_commands_(deploy_slash_commands),
+  welcome_squchan_(welcome_squchan) {
+  bot_->on_log([this](dpp::log_t const& event) { OnLog(event); });
+  bot_->on_message_create([this](dpp::message_create_t const& message_create) { OnMessageCreate(message_create); });
+  bot_->on_message_reaction_add([this](dpp::message_reaction_add_t const& message_reaction_add) { OnMessageReactionAdd(message_reaction_add); });
+  bot_->on_message_reaction_remove([this](dpp::message_reaction_remove_t const& message_reaction_remove) { OnMessageReactionRemove(message_reaction_remove); });
+  bot_->on_guild_members_chunk([this](dpp::guild_members_chunk_t const& guild_members_chunk) { OnGuildMembersChunk(guild_members_chunk); });
+  bot_->on_guild_member_update([this](dpp::guild_member_update_t const& guild_member_update) { OnGuildMemberUpdate(guild_member_update); });
+  bot_->on_ready([this](dpp::ready_t const& ready) { OnReady(ready); });
+  bot_->on_slashcommand([this](dpp::slashcommand_t const& slash_command) { OnSlashCommand(slash_command); });
 
-  bot_->direct_message_create_sync(Settings::Get().GetFolleUserId(), dpp::message("FINISHED INITIALISING BOT"));
+  // Only restores the persisted points, the backfill runs in the background so the gateway connects straight away
+  pokatto_prestige_ = std::make_unique<PokattoPrestige>(discord_client_, rest_budgeter_);
 
   logger_.Info("Initialised bot");
 }
@@ -69,13 +105,55 @@ void PokattoPrestigeBot::OnLog(dpp::log_t const& log) const noexcept {
   }
 }
 
+void PokattoPrestigeBot::OnMessageCreate(dpp::message_create_t const& message_create) noexcept {
+  pokatto_prestige_->AddSubmission(message_create.msg);
+}
+
 void PokattoPrestigeBot::OnMessageReactionAdd(dpp::message_reaction_add_t const& message_reaction_add) noexcept {
   pokatto_prestige_->AddRating(message_reaction_add.message_id, message_reaction_add.channel_id,
                                message_reaction_add.reacting_user.id, message_reaction_add.reacting_emoji.name);
 }
 
+void PokattoPrestigeBot::OnMessageReactionRemove(dpp::message_reaction_remove_t const& message_reaction_remove) noexcept {
+  pokatto_prestige_->RemoveRating(message_reaction_remove.message_id, message_reaction_remove.channel_id,
+                                  message_reaction_remove.reacting_user_id, message_reaction_remove.reacting_emoji.name);
+}
+
+void PokattoPrestigeBot::OnGuildMembersChunk(dpp::guild_members_chunk_t const& guild_members_chunk) noexcept {
+  if (nullptr == guild_members_chunk.members) {
+    return;
+  }
+
+  for (auto const& [user_id, guild_member] : *guild_members_chunk.members) {
+    if (auto const* const user = guild_member.get_user(); nullptr != user) {
+      pokatto_prestige_->UpdateUsername(user_id, user->username);
+    }
+  }
+}
+
+void PokattoPrestigeBot::OnGuildMemberUpdate(dpp::guild_member_update_t const& guild_member_update) noexcept {
+  if (auto const* const user = guild_member_update.updated.get_user(); nullptr != user) {
+    pokatto_prestige_->UpdateUsername(user->id, user->username);
+  }
+}
+
 void PokattoPrestigeBot::OnReady(dpp::ready_t const& ready) const noexcept {
   logger_.Info("Bot event handler loop started");
+
+  // Ready fires again on every reconnect, the announcements and the deployment are only done once
+  if (!dpp::run_once<struct announce_bot_ready>()) {
+    return;
+  }
+
+  SendDirectMessage(Settings::Get().GetFolleUserId(), "BOT CONNECTED");
+
+  if (deploy_slash_commands_) {
+    DeploySlashCommands();
+  }
+
+  if (welcome_squchan_) {
+    SendDirectMessage(Settings::Get().GetSquchanUserId(), "Hello Squ! Welcome to the Pokatto Prestige Bot!");
+  }
 }
 
 void PokattoPrestigeBot::OnSlashCommand(dpp::slashcommand_t const& slash_command) noexcept {
@@ -83,33 +161,78 @@ void PokattoPrestigeBot::OnSlashCommand(dpp::slashcommand_t const& slash_command
     logger_.Info("Received 'get_points_history' slash command. Username: '{}'. User id '{}'",
                  slash_command.command.get_issuing_user().username, slash_command.command.get_issuing_user().id);
 
-    auto const get_points_history_reply = dpp::message("Your points history will be DM'd to you soon.").set_flags(dpp::m_ephemeral);
-    slash_command.reply(get_points_history_reply);
+    auto const get_points_history_reply = dpp::message("Your points history will be DM'd to you soon." +
+                                                       ::GetReadinessNote(pokatto_prestige_->GetReadiness())).set_flags(dpp::m_ephemeral);
+    ReplyToSlashCommand(slash_command, get_points_history_reply);
 
     pokatto_prestige_->SendPointsHistory(slash_command.command.get_issuing_user().id);
+  } else if (slash_command.command.get_command_name() == kGetLeaderboardSlashCommand) {
+    logger_.Info("Received 'get_leaderboard' slash command. Username: '{}'. User id '{}'",
+                 slash_command.command.get_issuing_user().username, slash_command.command.get_issuing_user().id);
+
+    std::optional<std::chrono::year_month> month;
+    if (auto const* const month_string = std::get_if<std::string>(&slash_command.get_parameter(kMonthOption)); nullptr != month_string) {
+      std::chrono::year_month parsed_month{};
+      if (!::ParseMonth(*month_string, parsed_month)) {
+        auto const invalid_month_reply = dpp::message("Months are written as YYYY-MM, like 2024-03.").set_flags(dpp::m_ephemeral);
+        ReplyToSlashCommand(slash_command, invalid_month_reply);
+        return;
+      }
+
+      month = parsed_month;
+    }
+
+    auto const get_leaderboard_reply = dpp::message("The leaderboard will be DM'd to you soon." +
+                                                    ::GetReadinessNote(pokatto_prestige_->GetReadiness())).set_flags(dpp::m_ephemeral);
+    ReplyToSlashCommand(slash_command, get_leaderboard_reply);
+
+    pokatto_prestige_->SendLeaderboard(slash_command.command.get_issuing_user().id, month);
   } else if (slash_command.command.get_command_name() == kResyncMissedPointsSlashCommand) {
     logger_.Info("Received 'resync_missed_points' slash command");
 
     if (Settings::Get().GetSquchanUserId() != slash_command.command.get_issuing_user().id) {
       auto const invalid_user_reply = dpp::message("Only SquChan can trigger this command.").set_flags(dpp::m_ephemeral);
-      slash_command.reply(invalid_user_reply);
+      ReplyToSlashCommand(slash_command, invalid_user_reply);
+      return;
     }
 
     auto const resync_missed_points_reply = dpp::message("Triggered missed points resync.").set_flags(dpp::m_ephemeral);
-    slash_command.reply(resync_missed_points_reply);
+    ReplyToSlashCommand(slash_command, resync_missed_points_reply);
 
     pokatto_prestige_->ResyncMissedPoints();
   }
 }
 
+void PokattoPrestigeBot::ReplyToSlashCommand(dpp::slashcommand_t const& slash_command, dpp::message const& reply) const noexcept {
+  ::ReplyToSlashCommand(rest_budgeter_, slash_command, reply);
+}
+
+void PokattoPrestigeBot::SendDirectMessage(dpp::snowflake const user_id, std::string const& message) const noexcept {
+  // Sent asynchronously, blocking on REST calls would hold up the gateway events
+  bot_->direct_message_create(user_id, dpp::message(message), [this, user_id](dpp::confirmation_callback_t const& callback) {
+    if (callback.is_error()) {
+      logger_.Error("Failed to send direct message. User id: '{}'. Error: '{}'", user_id, callback.get_error().message);
+    }
+  });
+}
+
 bool PokattoPrestigeBot::DeploySlashCommands() const {
   if (dpp::run_once<struct register_bot_commands>()) {
     dpp::slashcommand get_points_history_command(kGetPointsHistorySlashCommand, "You will be DM'd all yours posts and points.", Settings::Get().GetBotUserId());
+    dpp::slashcommand get_leaderboard_command(kGetLeaderboardSlashCommand, "You will be DM'd the leaderboard of a month, or of this year so far.", Settings::Get().GetBotUserId());
+    get_leaderboard_command.add_option(dpp::command_option(dpp::co_string, kMonthOption, "Month as YYYY-MM, this year so far when left out.", false));
     dpp::slashcommand resync_missed_points_command(kResyncMissedPointsSlashCommand, "SquChan only. Triggers a resync of any missed points.", Settings::Get().GetBotUserId());
 
-    bot_->guild_bulk_command_create_sync({get_points_history_command, resync_missed_points_command}, Settings::Get().GetServerId());
+    // Deployed from the ready event, so it doesn't wait on the result
+    bot_->guild_bulk_command_create({get_points_history_command, get_leaderboard_command, resync_missed_points_command}, Settings::Get().GetServerId(),
+                                    [this](dpp::confirmation_callback_t const& callback) {
+      if (callback.is_error()) {
+        logger_.Error("Failed to deploy slash commands. Error: '{}'", callback.get_error().message);
+        return;
+      }
 
-    logger_.Info("Successfully deployed slash commands");
+      logger_.Info("Successfully deployed slash commands");
+    });
   }
 
   return true;
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include <dpp/dpp.h>
 
+#include "discord/cluster_discord_client.h"
 #include "pokatto_prestige/pokatto_prestige.h"
+#include "pokatto_prestige/scheduler/rest_budgeter.h"
 #include "settings/settings.h"
 #include "logger/logger_factory.h"
 
@@ -19,16 +22,32 @@ public:
 
 private:
   void OnLog(dpp::log_t const& log) const noexcept;
+  void OnMessageCreate(dpp::message_create_t const& message_create) noexcept;
   void OnMessageReactionAdd(dpp::message_reaction_add_t const& message_reaction_add) noexcept;
+  void OnMessageReactionRemove(dpp::message_reaction_remove_t const& message_reaction_remove) noexcept;
+  void OnGuildMembersChunk(dpp::guild_members_chunk_t const& guild_members_chunk) noexcept;
+  void OnGuildMemberUpdate(dpp::guild_member_update_t const& guild_member_update) noexcept;
   void OnReady(dpp::ready_t const& ready) const noexcept;
   void OnSlashCommand(dpp::slashcommand_t const& slash_command) noexcept;
 
   bool DeploySlashCommands() const;
 
+  void ReplyToSlashCommand(dpp::slashcommand_t const& slash_command, dpp::message const& reply) const noexcept;
+  void SendDirectMessage(dpp::snowflake user_id, std::string const& message) const noexcept;
+
 private:
   Logger const logger_ = LoggerFactory::Get().Create("Pokatto Prestige Bot");
 
-  std::shared_ptr<dpp::cluster> const bot_ = std::make_shared<dpp::cluster>(Settings::Get().GetBotToken(), dpp::i_default_intents);
+  // Guild members are a privileged intent, only needed to prefetch usernames through member chunks
+  std::shared_ptr<dpp::cluster> const bot_ = std::make_shared<dpp::cluster>(Settings::Get().GetBotToken(),
+                                                                            Settings::Get().GetPrefetchGuildMembers() ?
+                                                                              (dpp::i_default_intents | dpp::i_guild_members) :
+                                                                              dpp::i_default_intents);
+  std::shared_ptr<DiscordClient> const discord_client_ = std::make_shared<ClusterDiscordClient>(bot_);
+  std::shared_ptr<RestBudgeter> const rest_budgeter_ = std::make_shared<RestBudgeter>();
+
+  bool const deploy_slash_commands_;
+  bool const welcome_squchan_;
 
   std::unique_ptr<PokattoPrestige> pokatto_prestige_;
 };
\ No newline at end of file
@@ -1,61 +1,39 @@
 #include "settings.h"
 
+#include <algorithm>
 #include <fstream>
+#include <string_view>
 
 #include <nlohmann/json.hpp>
 
 namespace {
-  Settings::Threads ThreadStringToEnum(std::string const& thread) noexcept {
-    if (thread == "fanarts") {
-      return Settings::Threads::kSubmissionFanarts;
+  auto constexpr kDefaultLeaderboardUpdateIntervalSeconds = 30LL;
+  auto constexpr kMinLeaderboardUpdateIntervalSeconds = 1LL;
+  auto constexpr kDefaultLeaderboardUtcOffsetMinutes = 0LL;
+  auto constexpr kDefaultUsernameCacheTtlHours = 168LL;
+  auto constexpr kDefaultPrefetchGuildMembers = false;
+
+  auto constexpr kThreadsKeys = std::array<std::string_view, static_cast<size_t>(Settings::Threads::kEnd)>{
+    "", "fanarts", "memes", "thumbnails", "video_edits", "youtube_clips"
+  };
+
+  auto constexpr kRewardsKeys = std::array<std::string_view, static_cast<size_t>(Settings::Rewards::kEnd)>{
+    "", "special_discord_role", "chaos_cat_doodle", "pokattosona", "vip_on_twitch", "store_merch", "clay_pokatto"
+  };
+
+  template <typename Enum, size_t Size>
+  constexpr Enum KeyToEnum(std::array<std::string_view, Size> const& keys, std::string_view const key) noexcept {
+    for (auto value = static_cast<size_t>(Enum::kBegin); value < static_cast<size_t>(Enum::kEnd); ++value) {
+      if (keys[value] == key) {
+        return static_cast<Enum>(value);
+      }
     }
 
-    if (thread == "memes") {
-      return Settings::Threads::kSubmissionMemes;
-    }
-
-    if (thread == "thumbnails") {
-      return Settings::Threads::kSubmissionThumbnails;
-    }
-
-    if (thread == "video_edits") {
-      return Settings::Threads::kSubmissionVideosEdits;
-    }
-
-    if (thread == "youtube_clips") {
-      return Settings::Threads::kSubmissionYoutubeClips;
-    }
-
-    return Settings::Threads::kNone;
+    return Enum::kNone;
   }
 
-  Settings::Rewards RewardStringToEnum(std::string const& reward) noexcept {
-    if (reward == "special_discord_role") {
-      return Settings::Rewards::kSpecialDiscordRole;
-    }
-
-    if (reward == "chaos_cat_doodle") {
-      return Settings::Rewards::kChaosCatDoodle;
-    }
-
-    if (reward == "pokattosona") {
-      return Settings::Rewards::kPokattosona;
-    }
-
-    if (reward == "vip_on_twitch") {
-      return Settings::Rewards::kVipOnTwitch;
-    }
-
-    if (reward == "store_merch") {
-      return Settings::Rewards::kStoreMerch;
-    }
-
-    if (reward == "clay_pokatto") {
-      return Settings::Rewards::kClayPokatto;
-    }
-
-    return Settings::Rewards::kNone;
-  }
+  static_assert(Settings::Threads::kSubmissionYoutubeClips == ::KeyToEnum<Settings::Threads>(kThreadsKeys, "youtube_clips"));
+  static_assert(Settings::Rewards::kClayPokatto == ::KeyToEnum<Settings::Rewards>(kRewardsKeys, "clay_pokatto"));
 }
 
 Settings& Settings::Get() noexcept {
@@ -81,17 +59,31 @@ Settings::Settings() {
 
   auto const& submission_threads_ids_json = discord_settings_json["submission_threads_ids"];
   for (auto it_thread_id = submission_threads_ids_json.cbegin(); it_thread_id != submission_threads_ids_json.cend(); ++it_thread_id) {
-    threads_ids_[::ThreadStringToEnum(it_thread_id.key())] = it_thread_id.value().get<dpp::snowflake>();
+    threads_ids_[static_cast<size_t>(::KeyToEnum<Threads>(kThreadsKeys, it_thread_id.key()))] = it_thread_id.value().get<dpp::snowflake>();
+  }
+  threads_ids_[static_cast<size_t>(Threads::kNone)] = {};
+
+  for (auto thread = static_cast<size_t>(Threads::kBegin); thread < static_cast<size_t>(Threads::kEnd); ++thread) {
+    if (!threads_ids_[thread].empty()) {
+      channels_threads_.emplace(threads_ids_[thread], static_cast<Threads>(thread));
+    }
   }
-  threads_ids_[Threads::kNone] = {};
-  threads_ids_[Threads::kEnd] = {};
 
   auto const& rewards_price_json = discord_settings_json["rewards_prices"];
   for (auto it_reward_price = rewards_price_json.cbegin(); it_reward_price != rewards_price_json.cend(); ++it_reward_price) {
-    rewards_prices_[::RewardStringToEnum(it_reward_price.key())] = it_reward_price.value().get<size_t>();
+    rewards_prices_[static_cast<size_t>(::KeyToEnum<Rewards>(kRewardsKeys, it_reward_price.key()))] = it_reward_price.value().get<size_t>();
   }
-  rewards_prices_[Rewards::kNone] = {};
-  rewards_prices_[Rewards::kEnd] = {};
+  rewards_prices_[static_cast<size_t>(Rewards::kNone)] = {};
+
+  // The processing loop waits at most this long between passes, so it must never be zero
+  leaderboard_update_interval_ = std::chrono::seconds(std::max(discord_settings_json.value("leaderboard_update_interval_seconds", kDefaultLeaderboardUpdateIntervalSeconds),
+                                                               kMinLeaderboardUpdateIntervalSeconds));
+
+  leaderboard_utc_offset_ = std::chrono::minutes(discord_settings_json.value("leaderboard_utc_offset_minutes", kDefaultLeaderboardUtcOffsetMinutes));
+
+  username_cache_ttl_ = std::chrono::hours(discord_settings_json.value("username_cache_ttl_hours", kDefaultUsernameCacheTtlHours));
+
+  prefetch_guild_members_ = discord_settings_json.value("prefetch_guild_members", kDefaultPrefetchGuildMembers);
 }
 
 std::string const& Settings::GetBotToken() const noexcept {
@@ -119,9 +111,30 @@ dpp::snowflake Settings::GetPokattoPrestigePathChannelId() const noexcept {
 }
 
 dpp::snowflake Settings::GetThreadId(Threads const thread) const noexcept  {
-  return threads_ids_.at(thread);
+  return threads_ids_[static_cast<size_t>(thread)];
+}
+
+Settings::Threads Settings::GetThread(dpp::snowflake const channel_id) const noexcept {
+  auto const it_channel_thread = channels_threads_.find(channel_id);
+  return (channels_threads_.cend() == it_channel_thread) ? Threads::kNone : it_channel_thread->second;
+}
+
+Settings::RewardsPrices const& Settings::GetRewardsPrices() const noexcept {
+  return rewards_prices_;
+}
+
+std::chrono::seconds Settings::GetLeaderboardUpdateInterval() const noexcept {
+  return leaderboard_update_interval_;
+}
+
+std::chrono::minutes Settings::GetLeaderboardUtcOffset() const noexcept {
+  return leaderboard_utc_offset_;
+}
+
+std::chrono::seconds Settings::GetUsernameCacheTtl() const noexcept {
+  return username_cache_ttl_;
 }
 
-size_t Settings::GetRewardPrice(Rewards const reward) const noexcept {
-  return rewards_prices_.at(reward);
+bool Settings::GetPrefetchGuildMembers() const noexcept {
+  return prefetch_guild_members_;
 }
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <cstdlib>
-#include <map>
 #include <string>
+#include <unordered_map>
 
 #include <dpp/dpp.h>
 
@@ -31,6 +33,8 @@ public:
     kEnd
   };
 
+  using RewardsPrices = std::array<size_t, static_cast<size_t>(Rewards::kEnd) + 1>;
+
   static Settings& Get() noexcept;
 
   std::string const& GetBotToken() const noexcept;
@@ -41,8 +45,14 @@ public:
   dpp::snowflake GetServerId() const noexcept;
   dpp::snowflake GetPokattoPrestigePathChannelId() const noexcept;
   dpp::snowflake GetThreadId(Threads const thread) const noexcept;
+  Threads GetThread(dpp::snowflake channel_id) const noexcept;
+
+  RewardsPrices const& GetRewardsPrices() const noexcept;
 
-  size_t GetRewardPrice(Rewards const reward) const noexcept;
+  std::chrono::seconds GetLeaderboardUpdateInterval() const noexcept;
+  std::chrono::minutes GetLeaderboardUtcOffset() const noexcept;
+  std::chrono::seconds GetUsernameCacheTtl() const noexcept;
+  bool GetPrefetchGuildMembers() const noexcept;
 
 private:
   Settings();
@@ -60,7 +70,14 @@ private:
   dpp::snowflake folle_user_id_ = {};
   dpp::snowflake pokatto_prestige_path_channel_id_ = {};
 
-  std::map<Threads, dpp::snowflake> threads_ids_;
+  // Indexed by enum, kNone and anything unset stay zero
+  std::array<dpp::snowflake, static_cast<size_t>(Threads::kEnd) + 1> threads_ids_ = {};
+  std::unordered_map<dpp::snowflake, Threads> channels_threads_;
+
+  RewardsPrices rewards_prices_ = {};
 
-  std::map<Rewards, size_t> rewards_prices_;
+  std::chrono::seconds leaderboard_update_interval_ = {};
+  std::chrono::minutes leaderboard_utc_offset_ = {};
+  std::chrono::seconds username_cache_ttl_ = {};
+  bool prefetch_guild_members_ = false;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include <fmt/format.h>
 #include <spdlog/async.h>
@@ -15,38 +16,43 @@ public:
 
   template <typename... Args>
   void Trace(fmt::format_string<Args...> fmt, Args&&... args) const noexcept {
-    auto const message = fmt::format(fmt, std::forward<Args>(args)...);
-    logger_->trace(message);
+    Log<spdlog::level::trace>(fmt, std::forward<Args>(args)...);
   }
 
   template <typename... Args>
   void Debug(fmt::format_string<Args...> fmt, Args&&... args) const noexcept {
-    auto const message = fmt::format(fmt, std::forward<Args>(args)...);
-    logger_->debug(message);
+    Log<spdlog::level::debug>(fmt, std::forward<Args>(args)...);
   }
 
   template <typename... Args>
   void Info(fmt::format_string<Args...> fmt, Args&&... args) const noexcept {
-    auto const message = fmt::format(fmt, std::forward<Args>(args)...);
-    logger_->info(message);
+    Log<spdlog::level::info>(fmt, std::forward<Args>(args)...);
   }
 
   template <typename... Args>
   void Warn(fmt::format_string<Args...> fmt, Args&&... args) const noexcept {
-    auto const message = fmt::format(fmt, std::forward<Args>(args)...);
-    logger_->warn(message);
+    Log<spdlog::level::warn>(fmt, std::forward<Args>(args)...);
   }
 
   template <typename... Args>
   void Error(fmt::format_string<Args...> fmt, Args&&... args) const noexcept {
-    auto const message = fmt::format(fmt, std::forward<Args>(args)...);
-    logger_->error(message);
+    Log<spdlog::level::err>(fmt, std::forward<Args>(args)...);
   }
 
   template <typename... Args>
   void Critical(fmt::format_string<Args...> fmt, Args&&... args) const noexcept {
-    auto const message = fmt::format(fmt, std::forward<Args>(args)...);
-    logger_->critical(message);
+    Log<spdlog::level::critical>(fmt, std::forward<Args>(args)...);
+  }
+
+private:
+  // Levels below SPDLOG_ACTIVE_LEVEL compile to nothing
+  template <spdlog::level::level_enum Level, typename... Args>
+  void Log(fmt::format_string<Args...> fmt, Args&&... args) const noexcept {
+    if constexpr (SPDLOG_ACTIVE_LEVEL <= Level) {
+      if (logger_->should_log(Level)) {
+        logger_->log(Level, fmt, std::forward<Args>(args)...);
+      }
+    }
   }
 
 private:
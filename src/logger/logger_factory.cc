@@ -20,4 +20,8 @@ LoggerFactory::~LoggerFactory() {
 
 Logger LoggerFactory::Create(std::string const& name) const noexcept {
   return Logger(std::make_shared<spdlog::async_logger>(name, sinks_.begin(), sinks_.end(), spdlog::thread_pool()));
+}
+
+void LoggerFactory::SetStdoutLevel(spdlog::level::level_enum const level) noexcept {
+  stdout_sink_->set_level(level);
 }
\ No newline at end of file
@@ -16,6 +16,9 @@ public:
 
   Logger Create(std::string const& name) const noexcept;
 
+  // The file sink keeps logging everything
+  void SetStdoutLevel(spdlog::level::level_enum level) noexcept;
+
 private:
   LoggerFactory() noexcept;
   ~LoggerFactory();
@@ -0,0 +1,9 @@
+#include "counter.h"
+
+void Counter::Increment(uint64_t const value) noexcept {
+  value_.fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t Counter::GetValue() const noexcept {
+  return value_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+class Counter final {
+public:
+  Counter() = default;
+  ~Counter() = default;
+
+  Counter(Counter const&) = delete;
+  void operator=(Counter const&) = delete;
+
+  void Increment(uint64_t value = 1) noexcept;
+
+  uint64_t GetValue() const noexcept;
+
+private:
+  std::atomic<uint64_t> value_ = {};
+};
@@ -0,0 +1,13 @@
+#include "gauge.h"
+
+void Gauge::Set(int64_t const value) noexcept {
+  value_.store(value, std::memory_order_relaxed);
+}
+
+void Gauge::Add(int64_t const value) noexcept {
+  value_.fetch_add(value, std::memory_order_relaxed);
+}
+
+int64_t Gauge::GetValue() const noexcept {
+  return value_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+class Gauge final {
+public:
+  Gauge() = default;
+  ~Gauge() = default;
+
+  Gauge(Gauge const&) = delete;
+  void operator=(Gauge const&) = delete;
+
+  void Set(int64_t value) noexcept;
+  void Add(int64_t value) noexcept;
+
+  int64_t GetValue() const noexcept;
+
+private:
+  std::atomic<int64_t> value_ = {};
+};
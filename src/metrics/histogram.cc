@@ -0,0 +1,77 @@
+#include "histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <vector>
+
+void Histogram::Record(std::chrono::steady_clock::duration const duration) noexcept {
+  auto const value = static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+
+  buckets_[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+
+  auto max = max_.load(std::memory_order_relaxed);
+  while ((max < value) && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+Histogram::Summary Histogram::GetSummary() const noexcept {
+  // Records landing while the buckets are read only skew this summary, the next one includes them
+  std::vector<uint64_t> buckets(kBuckets);
+  uint64_t count{};
+  for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+    buckets[bucket] = buckets_[bucket].load(std::memory_order_relaxed);
+    count += buckets[bucket];
+  }
+
+  Summary summary;
+  summary.count = count;
+  summary.sum = std::chrono::microseconds(sum_.load(std::memory_order_relaxed));
+  summary.max = std::chrono::microseconds(max_.load(std::memory_order_relaxed));
+  if (0 < count) {
+    // Buckets only know their upper bound, which can be past anything actually recorded
+    summary.p50 = std::min(summary.max, std::chrono::microseconds(GetQuantile(buckets, count, 0.5)));
+    summary.p90 = std::min(summary.max, std::chrono::microseconds(GetQuantile(buckets, count, 0.9)));
+    summary.p99 = std::min(summary.max, std::chrono::microseconds(GetQuantile(buckets, count, 0.99)));
+  }
+
+  return summary;
+}
+
+uint64_t Histogram::GetQuantile(std::vector<uint64_t> const& buckets, uint64_t const count, double const quantile) noexcept {
+  auto const target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count))));
+
+  uint64_t cumulative{};
+  for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+    cumulative += buckets[bucket];
+    if (cumulative >= target) {
+      return GetBucketHighestValue(bucket);
+    }
+  }
+
+  return 0;
+}
+
+size_t Histogram::GetBucket(uint64_t const value) noexcept {
+  if (value < kSubBuckets) {
+    return static_cast<size_t>(value);
+  }
+
+  auto const exponent = static_cast<size_t>(std::bit_width(value)) - 1;
+  auto const sub_bucket = static_cast<size_t>(value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+
+  return (exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+uint64_t Histogram::GetBucketHighestValue(size_t const bucket) noexcept {
+  if (bucket < kSubBuckets) {
+    return bucket;
+  }
+
+  auto const exponent = (bucket / kSubBuckets) + kSubBucketBits - 1;
+  auto const sub_bucket = bucket % kSubBuckets;
+  auto const lowest_value = (kSubBuckets + sub_bucket) << (exponent - kSubBucketBits);
+
+  return lowest_value + (1ULL << (exponent - kSubBucketBits)) - 1;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Durations in microseconds, HDR style buckets keep quantiles within 12.5%. Recording never locks.
+class Histogram final {
+public:
+  struct Summary final {
+    uint64_t count = {};
+    std::chrono::microseconds sum = {};
+    std::chrono::microseconds max = {};
+    std::chrono::microseconds p50 = {};
+    std::chrono::microseconds p90 = {};
+    std::chrono::microseconds p99 = {};
+  };
+
+  Histogram() = default;
+  ~Histogram() = default;
+
+  Histogram(Histogram const&) = delete;
+  void operator=(Histogram const&) = delete;
+
+  void Record(std::chrono::steady_clock::duration duration) noexcept;
+
+  Summary GetSummary() const noexcept;
+
+private:
+  static size_t constexpr kSubBucketBits = 3;
+  static size_t constexpr kSubBuckets = 1ULL << kSubBucketBits;
+  static size_t constexpr kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  static size_t GetBucket(uint64_t value) noexcept;
+  static uint64_t GetBucketHighestValue(size_t bucket) noexcept;
+  static uint64_t GetQuantile(std::vector<uint64_t> const& buckets, uint64_t count, double quantile) noexcept;
+
+private:
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_ = {};
+  std::atomic<uint64_t> sum_ = {};
+  std::atomic<uint64_t> max_ = {};
+};
@@ -0,0 +1,161 @@
+#include "metrics_registry.h"
+
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#include <fmt/format.h>
+
+namespace {
+  auto constexpr kMetricsDirectory = "metrics";
+  auto constexpr kMetricsFilePath = "metrics/pokatto_prestige.prom";
+  auto constexpr kTemporaryMetricsFilePath = "metrics/pokatto_prestige.prom.tmp";
+
+  std::string GetSeries(std::string const& name, std::string const& labels, std::string const& extra_label = {}) noexcept {
+    if (labels.empty() && extra_label.empty()) {
+      return name;
+    }
+
+    auto const separator = (labels.empty() || extra_label.empty()) ? "" : ",";
+    return fmt::format("{}{{{}{}{}}}", name, labels, separator, extra_label);
+  }
+
+  double GetSeconds(std::chrono::microseconds const duration) noexcept {
+    return std::chrono::duration<double>(duration).count();
+  }
+
+  double GetMilliseconds(std::chrono::microseconds const duration) noexcept {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+}
+
+MetricsRegistry& MetricsRegistry::Get() noexcept {
+  static MetricsRegistry metrics_registry;
+  return metrics_registry;
+}
+
+Counter& MetricsRegistry::GetCounter(std::string const& name, std::string const& help, std::string const& labels) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(metrics_mutex_);
+  return GetMetric(counters_, name, help, labels);
+}
+
+Gauge& MetricsRegistry::GetGauge(std::string const& name, std::string const& help, std::string const& labels) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(metrics_mutex_);
+  return GetMetric(gauges_, name, help, labels);
+}
+
+Histogram& MetricsRegistry::GetHistogram(std::string const& name, std::string const& help, std::string const& labels) noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(metrics_mutex_);
+  return GetMetric(histograms_, name, help, labels);
+}
+
+std::string MetricsRegistry::Export() const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(metrics_mutex_);
+
+  fmt::memory_buffer exported_metrics;
+  auto exported_metrics_iterator = std::back_inserter(exported_metrics);
+
+  for (auto const& [name, family] : counters_) {
+    fmt::format_to(exported_metrics_iterator, "# HELP {} {}\n# TYPE {} counter\n", name, family.help, name);
+    for (auto const& [labels, counter] : family.labels_metrics) {
+      fmt::format_to(exported_metrics_iterator, "{} {}\n", ::GetSeries(name, labels), counter->GetValue());
+    }
+  }
+
+  for (auto const& [name, family] : gauges_) {
+    fmt::format_to(exported_metrics_iterator, "# HELP {} {}\n# TYPE {} gauge\n", name, family.help, name);
+    for (auto const& [labels, gauge] : family.labels_metrics) {
+      fmt::format_to(exported_metrics_iterator, "{} {}\n", ::GetSeries(name, labels), gauge->GetValue());
+    }
+  }
+
+  // The buckets are too fine to export as a Prometheus histogram, so they are exported as a summary of quantiles
+  for (auto const& [name, family] : histograms_) {
+    fmt::format_to(exported_metrics_iterator, "# HELP {} {}\n# TYPE {} summary\n", name, family.help, name);
+    for (auto const& [labels, histogram] : family.labels_metrics) {
+      auto const summary = histogram->GetSummary();
+      fmt::format_to(exported_metrics_iterator, "{} {}\n", ::GetSeries(name, labels, "quantile=\"0.5\""), ::GetSeconds(summary.p50));
+      fmt::format_to(exported_metrics_iterator, "{} {}\n", ::GetSeries(name, labels, "quantile=\"0.9\""), ::GetSeconds(summary.p90));
+      fmt::format_to(exported_metrics_iterator, "{} {}\n", ::GetSeries(name, labels, "quantile=\"0.99\""), ::GetSeconds(summary.p99));
+      fmt::format_to(exported_metrics_iterator, "{} {}\n", ::GetSeries(name + "_sum", labels), ::GetSeconds(summary.sum));
+      fmt::format_to(exported_metrics_iterator, "{} {}\n", ::GetSeries(name + "_count", labels), summary.count);
+    }
+  }
+
+  return fmt::to_string(exported_metrics);
+}
+
+bool MetricsRegistry::StoreExport() const noexcept {
+  std::error_code error_code;
+  if (!std::filesystem::exists(kMetricsDirectory, error_code) && !std::filesystem::create_directory(kMetricsDirectory, error_code)) {
+    return false;
+  }
+
+  {
+    std::ofstream output_file(kTemporaryMetricsFilePath, std::ios_base::out | std::ios_base::trunc);
+    try {
+      output_file << Export();
+    } catch (std::exception const& exception) {
+      return false;
+    }
+
+    if (!output_file.good()) {
+      return false;
+    }
+  }
+
+  // Collectors read the file at any time, so it is replaced whole
+  std::filesystem::rename(kTemporaryMetricsFilePath, kMetricsFilePath, error_code);
+
+  return !error_code;
+}
+
+std::vector<std::string> MetricsRegistry::GetSummaries() const noexcept {
+  std::lock_guard<std::mutex> const mutex_lock_guard(metrics_mutex_);
+
+  std::vector<std::string> summaries;
+  for (auto const& [name, family] : histograms_) {
+    for (auto const& [labels, histogram] : family.labels_metrics) {
+      auto const summary = histogram->GetSummary();
+      if (0 == summary.count) {
+        continue;
+      }
+
+      summaries.push_back(fmt::format("{}. Count: '{}'. P50: '{:.3f}ms'. P90: '{:.3f}ms'. P99: '{:.3f}ms'. Max: '{:.3f}ms'",
+                                      ::GetSeries(name, labels), summary.count, ::GetMilliseconds(summary.p50),
+                                      ::GetMilliseconds(summary.p90), ::GetMilliseconds(summary.p99), ::GetMilliseconds(summary.max)));
+    }
+  }
+
+  for (auto const& [name, family] : counters_) {
+    for (auto const& [labels, counter] : family.labels_metrics) {
+      summaries.push_back(fmt::format("{}. Value: '{}'", ::GetSeries(name, labels), counter->GetValue()));
+    }
+  }
+
+  for (auto const& [name, family] : gauges_) {
+    for (auto const& [labels, gauge] : family.labels_metrics) {
+      summaries.push_back(fmt::format("{}. Value: '{}'", ::GetSeries(name, labels), gauge->GetValue()));
+    }
+  }
+
+  return summaries;
+}
+
+template <typename Metric>
+Metric& MetricsRegistry::GetMetric(std::map<std::string, Family<Metric>>& families, std::string const& name, std::string const& help,
+                                   std::string const& labels) noexcept {
+  auto& family = families[name];
+  if (family.help.empty()) {
+    family.help = help;
+  }
+
+  auto& metric = family.labels_metrics[labels];
+  if (!metric) {
+    metric = std::make_unique<Metric>();
+  }
+
+  return *metric;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "counter.h"
+#include "gauge.h"
+#include "histogram.h"
+
+// Process wide metrics, exported in the Prometheus text format for a node exporter textfile collector
+class MetricsRegistry final {
+public:
+  static MetricsRegistry& Get() noexcept;
+
+  Counter& GetCounter(std::string const& name, std::string const& help, std::string const& labels = {}) noexcept;
+  Gauge& GetGauge(std::string const& name, std::string const& help, std::string const& labels = {}) noexcept;
+  Histogram& GetHistogram(std::string const& name, std::string const& help, std::string const& labels = {}) noexcept;
+
+  std::string Export() const noexcept;
+  bool StoreExport() const noexcept;
+
+  std::vector<std::string> GetSummaries() const noexcept;
+
+private:
+  template <typename Metric>
+  struct Family final {
+    std::string help;
+    std::map<std::string, std::unique_ptr<Metric>> labels_metrics;
+  };
+
+  MetricsRegistry() = default;
+  ~MetricsRegistry() = default;
+
+  MetricsRegistry(MetricsRegistry const&) = delete;
+  void operator=(MetricsRegistry const&) = delete;
+
+  template <typename Metric>
+  static Metric& GetMetric(std::map<std::string, Family<Metric>>& families, std::string const& name, std::string const& help,
+                           std::string const& labels) noexcept;
+
+private:
+  mutable std::mutex metrics_mutex_;
+  std::map<std::string, Family<Counter>> counters_;
+  std::map<std::string, Family<Gauge>> gauges_;
+  std::map<std::string, Family<Histogram>> histograms_;
+};